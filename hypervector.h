@@ -2,6 +2,9 @@
 #define HYPERVECTOR_H
 
 #include "hypervector_container.h"
+#include "hypervector_instrumentation.h"
+#include "hypervector_interop.h"
 #include "hypervector_print.h"
+#include "hypervector_ref.h"
 
 #endif // HYPERVECTOR_H
@@ -0,0 +1,814 @@
+#include "hypervector.h"
+#include "hypervector_compressed.h"
+#include "hypervector_linalg.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using size_type = hypervector_detail::size_type;
+
+template<size_t Dims>
+using shape_t = std::array<size_type, Dims>;
+
+// shapes of roughly the same element count for each number of dimensions
+constexpr shape_t<1> shape1 = {32768};
+constexpr shape_t<2> shape2 = {181, 181};
+constexpr shape_t<3> shape3 = {32, 32, 32};
+constexpr shape_t<4> shape4 = {13, 13, 13, 13};
+constexpr shape_t<5> shape5 = {8, 8, 8, 8, 8};
+
+
+template<typename T>
+void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif
+}
+
+
+template<typename T>
+T make_value(size_type i);
+
+template<>
+int make_value<int>(size_type i) {
+  return static_cast<int>(i);
+}
+
+template<>
+double make_value<double>(size_type i) {
+  return static_cast<double>(i) * 0.5;
+}
+
+template<>
+std::string make_value<std::string>(size_type i) {
+  return std::to_string(i);
+}
+
+
+template<typename T>
+size_type checksum(const T& value) {
+  return static_cast<size_type>(value);
+}
+
+size_type checksum(const std::string& value) {
+  return value.size();
+}
+
+
+template<typename T>
+const char* type_name();
+
+template<>
+const char* type_name<int>() {
+  return "int";
+}
+
+template<>
+const char* type_name<float>() {
+  return "float";
+}
+
+template<>
+const char* type_name<double>() {
+  return "double";
+}
+
+template<>
+const char* type_name<std::string>() {
+  return "std::string";
+}
+
+
+template<size_t Dims>
+size_type element_count(const shape_t<Dims>& shape) {
+  size_type count = 1;
+  for (auto size : shape)
+    count *= size;
+  return count;
+}
+
+
+// call f(indices...) for all indices of the given shape in storage order
+template<size_t Dim = 0, size_t Dims, typename F, typename ...Indices>
+void for_each_index(const shape_t<Dims>& shape, F&& f, Indices... indices) {
+  if constexpr (Dim == Dims) {
+    f(indices...);
+  } else {
+    for (size_type i = 0; i < shape[Dim]; ++i)
+      for_each_index<Dim + 1>(shape, f, indices..., i);
+  }
+}
+
+
+// chained operator[] on containers that support subscripting down to elements
+template<typename C>
+decltype(auto) subscript(C&& c, size_type index0) {
+  return c[index0];
+}
+
+template<typename C, typename ...Indices>
+decltype(auto) subscript(C&& c, size_type index0, Indices... indices) {
+  return subscript(c[index0], indices...);
+}
+
+
+struct hypervector_adapter
+{
+  static constexpr const char* name = "hypervector";
+
+  template<typename T, size_t Dims>
+  using container = hypervector<T, Dims>;
+
+  template<typename T, size_t Dims>
+  static container<T, Dims> construct(const shape_t<Dims>& shape, const T& value) {
+    return std::apply([&](auto... sizes) {
+      return container<T, Dims>(sizes..., value);
+    }, shape);
+  }
+
+  template<typename T, size_t Dims>
+  static void assign(container<T, Dims>& c, const shape_t<Dims>& shape, const T& value) {
+    std::apply([&](auto... sizes) { c.assign(sizes..., value); }, shape);
+  }
+
+  template<typename T, size_t Dims>
+  static void resize(container<T, Dims>& c, const shape_t<Dims>& shape) {
+    std::apply([&](auto... sizes) { c.resize(sizes...); }, shape);
+  }
+
+  template<typename T, size_t Dims>
+  static container<T, Dims> reserve(const shape_t<Dims>& shape) {
+    container<T, Dims> c;
+    std::apply([&](auto... sizes) { c.reserve(sizes...); }, shape);
+    return c;
+  }
+
+  template<typename T, size_t Dims, typename ...Indices>
+  static const T& at(const container<T, Dims>& c, const shape_t<Dims>&, Indices... indices) {
+    return c.at(indices...);
+  }
+
+  template<typename T, size_t Dims, typename ...Indices>
+  static const T& subscript(const container<T, Dims>& c, const shape_t<Dims>&, Indices... indices) {
+    return ::subscript(c, indices...);
+  }
+
+  template<typename T, size_t Dims, typename F>
+  static void for_each_linear(const container<T, Dims>& c, F&& f) {
+    for (auto it = c.begin(), last = c.end(); it != last; ++it)
+      f(*it);
+  }
+
+  template<typename T, size_t Dims, typename F>
+  static void for_each_slice(const container<T, Dims>& c, const shape_t<Dims>&, F&& f) {
+    for (size_type i = 0; i < c.template sizeOf<0>(); ++i)
+      for (auto&& v : c[i])
+        f(v);
+  }
+
+  template<typename T, size_t Dims, typename F>
+  static void for_each_linear(container<T, Dims>& c, F&& f) {
+    for (auto& v : c)
+      f(v);
+  }
+};
+
+
+struct flat_vector_adapter
+{
+  static constexpr const char* name = "std::vector<T>";
+
+  template<typename T, size_t>
+  using container = std::vector<T>;
+
+  template<typename T, size_t Dims>
+  static container<T, Dims> construct(const shape_t<Dims>& shape, const T& value) {
+    return container<T, Dims>(element_count(shape), value);
+  }
+
+  template<typename T, size_t Dims>
+  static void assign(container<T, Dims>& c, const shape_t<Dims>& shape, const T& value) {
+    c.assign(element_count(shape), value);
+  }
+
+  template<typename T, size_t Dims>
+  static void resize(container<T, Dims>& c, const shape_t<Dims>& shape) {
+    c.resize(element_count(shape));
+  }
+
+  template<typename T, size_t Dims>
+  static container<T, Dims> reserve(const shape_t<Dims>& shape) {
+    container<T, Dims> c;
+    c.reserve(element_count(shape));
+    return c;
+  }
+
+  template<typename T, size_t Dims, typename ...Indices>
+  static const T& at(const container<T, Dims>& c, const shape_t<Dims>& shape, Indices... indices) {
+    return c.at(index_of(shape, indices...));
+  }
+
+  template<typename T, size_t Dims, typename ...Indices>
+  static const T& subscript(const container<T, Dims>& c, const shape_t<Dims>& shape, Indices... indices) {
+    return c[index_of(shape, indices...)];
+  }
+
+  template<typename C, typename F>
+  static void for_each_linear(C& c, F&& f) {
+    for (auto it = c.data(), last = c.data() + c.size(); it != last; ++it)
+      f(*it);
+  }
+
+  template<typename C, size_t Dims, typename F>
+  static void for_each_slice(const C& c, const shape_t<Dims>& shape, F&& f) {
+    // slices along dimension 0 are contiguous runs of equal length
+    const auto stride = c.size() / std::max<size_type>(shape[0], 1);
+    for (size_type i = 0; i < shape[0]; ++i)
+      for (auto it = c.data() + i * stride, last = it + stride; it != last; ++it)
+        f(*it);
+  }
+
+private:
+  template<size_t Dims, typename ...Indices>
+  static size_type index_of(const shape_t<Dims>& shape, Indices... indices) {
+    const shape_t<Dims> index = {indices...};
+    size_type linear = 0;
+    for (size_t dim = 0; dim < Dims; ++dim)
+      linear = linear * shape[dim] + index[dim];
+    return linear;
+  }
+};
+
+
+template<typename T, size_t Dims>
+struct nested_vector
+{
+  using type = std::vector<typename nested_vector<T, Dims - 1>::type>;
+};
+
+template<typename T>
+struct nested_vector<T, 1>
+{
+  using type = std::vector<T>;
+};
+
+
+struct nested_vector_adapter
+{
+  static constexpr const char* name = "std::vector<std::vector<T>>";
+
+  template<typename T, size_t Dims>
+  using container = typename nested_vector<T, Dims>::type;
+
+  template<typename T, size_t Dims, size_t Dim = 0>
+  static container<T, Dims - Dim> construct(const shape_t<Dims>& shape, const T& value) {
+    if constexpr (Dim + 1 == Dims) {
+      return container<T, 1>(shape[Dim], value);
+    } else {
+      return container<T, Dims - Dim>(shape[Dim], construct<T, Dims, Dim + 1>(shape, value));
+    }
+  }
+
+  template<typename T, size_t Dims>
+  static void assign(container<T, Dims>& c, const shape_t<Dims>& shape, const T& value) {
+    if constexpr (Dims == 1) {
+      c.assign(shape[0], value);
+    } else {
+      c.assign(shape[0], construct<T, Dims, 1>(shape, value));
+    }
+  }
+
+  template<typename T, size_t Dims, size_t Dim = 0>
+  static void resize(container<T, Dims - Dim>& c, const shape_t<Dims>& shape) {
+    c.resize(shape[Dim]);
+    if constexpr (Dim + 1 < Dims) {
+      for (auto& sub : c)
+        resize<T, Dims, Dim + 1>(sub, shape);
+    }
+  }
+
+  template<typename T, size_t Dims>
+  static container<T, Dims> reserve(const shape_t<Dims>& shape) {
+    // only the outermost vector can be reserved without constructing the inner ones
+    container<T, Dims> c;
+    c.reserve(shape[0]);
+    return c;
+  }
+
+  template<typename T, size_t Dims, typename ...Indices>
+  static const T& at(const container<T, Dims>& c, const shape_t<Dims>&, Indices... indices) {
+    return at_(c, indices...);
+  }
+
+  template<typename T, size_t Dims, typename ...Indices>
+  static const T& subscript(const container<T, Dims>& c, const shape_t<Dims>&, Indices... indices) {
+    return ::subscript(c, indices...);
+  }
+
+  template<typename C, typename F>
+  static void for_each_linear(C&& c, F&& f) {
+    for (auto&& sub : c) {
+      if constexpr (std::is_class_v<std::decay_t<decltype(sub)>>
+                 && !std::is_same_v<std::decay_t<decltype(sub)>, std::string>) {
+        for_each_linear(sub, f);
+      } else {
+        f(sub);
+      }
+    }
+  }
+
+  template<typename C, size_t Dims, typename F>
+  static void for_each_slice(const C& c, const shape_t<Dims>&, F&& f) {
+    for (auto&& sub : c)
+      for_each_linear(sub, f);
+  }
+
+private:
+  template<typename C>
+  static decltype(auto) at_(const C& c, size_type index0) {
+    return c.at(index0);
+  }
+
+  template<typename C, typename ...Indices>
+  static decltype(auto) at_(const C& c, size_type index0, Indices... indices) {
+    return at_(c.at(index0), indices...);
+  }
+};
+
+
+struct result
+{
+  std::string op;
+  std::string container;
+  std::string type;
+  std::vector<size_type> shape;
+  size_type elements;
+  size_type iterations;
+  double ns_min;
+  double ns_median;
+  std::vector<std::pair<std::string, double>> metrics; ///< additional per-benchmark values
+};
+
+
+struct options
+{
+  std::string out; ///< output file; stdout if empty
+  std::string filter; ///< substring an "op/container/type/dims" key must contain
+  size_type repetitions = 5; ///< samples taken per benchmark
+  std::chrono::nanoseconds min_time = std::chrono::milliseconds(5); ///< minimum duration of one sample
+};
+
+
+class runner
+{
+  const options& opts_;
+  std::vector<result> results_;
+
+public:
+  explicit runner(const options& opts)
+    : opts_(opts) {
+  }
+
+
+  /// whether the filter selects any of the given ops, i.e. their setup is needed
+  template<typename Adapter, typename T, size_t Dims>
+  bool selected(std::initializer_list<const char*> ops) const {
+    return std::any_of(ops.begin(), ops.end(), [this](const char* op) {
+      return key_<Adapter, T, Dims>(op).find(opts_.filter) != std::string::npos;
+    });
+  }
+
+
+  template<typename Adapter, typename T, size_t Dims, typename F>
+  void run(
+      const char* op,
+      const shape_t<Dims>& shape,
+      F&& f,
+      std::vector<std::pair<std::string, double>> metrics = {}) {
+    auto key = key_<Adapter, T, Dims>(op);
+    if (key.find(opts_.filter) == std::string::npos)
+      return;
+
+    using clock = std::chrono::steady_clock;
+
+    f(); // warm-up
+
+    // calibrate the number of iterations per sample
+    size_type iterations = 1;
+    for (;;) {
+      auto start = clock::now();
+      for (size_type i = 0; i < iterations; ++i)
+        f();
+      if (clock::now() - start >= opts_.min_time)
+        break;
+      iterations *= 2;
+    }
+
+    std::vector<double> samples;
+    for (size_type rep = 0; rep < opts_.repetitions; ++rep) {
+      auto start = clock::now();
+      for (size_type i = 0; i < iterations; ++i)
+        f();
+      auto elapsed = std::chrono::duration<double, std::nano>(clock::now() - start);
+      samples.push_back(elapsed.count() / static_cast<double>(iterations));
+    }
+    std::sort(samples.begin(), samples.end());
+
+    results_.push_back(result{
+      op,
+      Adapter::name,
+      type_name<T>(),
+      std::vector<size_type>(shape.begin(), shape.end()),
+      element_count(shape),
+      iterations,
+      samples.front(),
+      samples[samples.size() / 2],
+      std::move(metrics)
+    });
+    std::cerr << key << ": " << samples[samples.size() / 2] << " ns\n";
+  }
+
+
+  void write_json(std::ostream& os) const {
+    os << "{\n"
+       << "  \"context\": {\n"
+#if defined(__VERSION__)
+       << "    \"compiler\": \"" << __VERSION__ << "\",\n"
+#endif
+#if defined(NDEBUG)
+       << "    \"ndebug\": true,\n"
+#else
+       << "    \"ndebug\": false,\n"
+#endif
+       << "    \"repetitions\": " << opts_.repetitions << "\n"
+       << "  },\n"
+       << "  \"benchmarks\": [";
+    const char* separator = "\n";
+    for (auto&& r : results_) {
+      os << separator
+         << "    {\"op\": \"" << r.op << "\""
+         << ", \"container\": \"" << r.container << "\""
+         << ", \"type\": \"" << r.type << "\""
+         << ", \"dims\": " << r.shape.size()
+         << ", \"shape\": [";
+      const char* dim_separator = "";
+      for (auto size : r.shape) {
+        os << dim_separator << size;
+        dim_separator = ", ";
+      }
+      os << "]"
+         << ", \"elements\": " << r.elements
+         << ", \"iterations\": " << r.iterations
+         << ", \"ns_per_op_min\": " << r.ns_min
+         << ", \"ns_per_op_median\": " << r.ns_median
+         << ", \"ns_per_element_median\": " << r.ns_median / static_cast<double>(std::max<size_type>(r.elements, 1));
+      for (auto&& [name, value] : r.metrics)
+        os << ", \"" << name << "\": " << value;
+      os << "}";
+      separator = ",\n";
+    }
+    os << "\n  ]\n}\n";
+  }
+
+private:
+  template<typename Adapter, typename T, size_t Dims>
+  static std::string key_(const char* op) {
+    return std::string(op) + "/" + Adapter::name + "/" + type_name<T>() + "/" + std::to_string(Dims) + "D";
+  }
+};
+
+
+template<typename Adapter, typename T, size_t Dims>
+void bench(runner& r, const shape_t<Dims>& shape) {
+  using container = typename Adapter::template container<T, Dims>;
+  if (!r.template selected<Adapter, T, Dims>({"construct", "assign", "resize", "reserve", "traverse_at",
+      "traverse_subscript", "traverse_linear", "slice_iterate", "copy", "move", "operator=="}))
+    return;
+
+  const T value = make_value<T>(42);
+
+  r.template run<Adapter, T, Dims>("construct", shape, [&] {
+    auto c = Adapter::construct(shape, value);
+    do_not_optimize(c);
+  });
+
+  {
+    container c;
+    r.template run<Adapter, T, Dims>("assign", shape, [&] {
+      Adapter::assign(c, shape, value);
+      do_not_optimize(c);
+    });
+  }
+
+  {
+    // alternate between full and half outer extent on the same reserved storage
+    auto half = shape;
+    half[0] /= 2;
+    container c;
+    Adapter::template resize<T, Dims>(c, shape);
+    r.template run<Adapter, T, Dims>("resize", shape, [&] {
+      Adapter::template resize<T, Dims>(c, half);
+      Adapter::template resize<T, Dims>(c, shape);
+      do_not_optimize(c);
+    });
+  }
+
+  r.template run<Adapter, T, Dims>("reserve", shape, [&] {
+    auto c = Adapter::template reserve<T, Dims>(shape);
+    do_not_optimize(c);
+  });
+
+  auto c = Adapter::construct(shape, value);
+  {
+    size_type i = 0;
+    Adapter::for_each_linear(c, [&](T& v) { v = make_value<T>(i++); });
+  }
+  const auto& cc = c;
+
+  r.template run<Adapter, T, Dims>("traverse_at", shape, [&] {
+    size_type sum = 0;
+    for_each_index(shape, [&](auto... indices) {
+      sum += checksum(Adapter::template at<T, Dims>(cc, shape, indices...));
+    });
+    do_not_optimize(sum);
+  });
+
+  r.template run<Adapter, T, Dims>("traverse_subscript", shape, [&] {
+    size_type sum = 0;
+    for_each_index(shape, [&](auto... indices) {
+      sum += checksum(Adapter::template subscript<T, Dims>(cc, shape, indices...));
+    });
+    do_not_optimize(sum);
+  });
+
+  r.template run<Adapter, T, Dims>("traverse_linear", shape, [&] {
+    size_type sum = 0;
+    Adapter::for_each_linear(cc, [&](const T& v) { sum += checksum(v); });
+    do_not_optimize(sum);
+  });
+
+  if constexpr (Dims > 1) {
+    r.template run<Adapter, T, Dims>("slice_iterate", shape, [&] {
+      size_type sum = 0;
+      Adapter::for_each_slice(cc, shape, [&](const T& v) { sum += checksum(v); });
+      do_not_optimize(sum);
+    });
+  }
+
+  r.template run<Adapter, T, Dims>("copy", shape, [&] {
+    container copy = cc;
+    do_not_optimize(copy);
+  });
+
+  {
+    container moved = cc;
+    r.template run<Adapter, T, Dims>("move", shape, [&] {
+      container tmp = std::move(moved);
+      moved = std::move(tmp);
+      do_not_optimize(moved);
+    });
+  }
+
+  {
+    const container copy = cc;
+    r.template run<Adapter, T, Dims>("operator==", shape, [&] {
+      bool equal = (cc == copy);
+      do_not_optimize(equal);
+    });
+  }
+}
+
+
+template<typename T, size_t Dims>
+void bench_all(runner& r, const shape_t<Dims>& shape) {
+  bench<hypervector_adapter, T, Dims>(r, shape);
+  bench<flat_vector_adapter, T, Dims>(r, shape);
+  bench<nested_vector_adapter, T, Dims>(r, shape);
+}
+
+
+template<typename T>
+void bench_all(runner& r) {
+  bench_all<T>(r, shape1);
+  bench_all<T>(r, shape2);
+  bench_all<T>(r, shape3);
+  bench_all<T>(r, shape4);
+  bench_all<T>(r, shape5);
+}
+
+
+struct naive_adapter
+{
+  static constexpr const char* name = "naive";
+};
+
+
+struct linalg_adapter
+{
+  static constexpr const char* name = "hypervector_linalg";
+};
+
+
+template<typename T>
+void bench_linalg(runner& r, size_type size) {
+  const shape_t<2> shape = {size, size};
+  if (!r.template selected<naive_adapter, T, 2>({"gemm", "gemv"}) &&
+      !r.template selected<linalg_adapter, T, 2>({"gemm", "gemv"}))
+    return;
+
+  hypervector<T, 2> a(size, size), b(size, size), c(size, size, T());
+  {
+    size_type i = 0;
+    for (auto& v : a)
+      v = static_cast<T>(i++ % 7) - T(3);
+    for (auto& v : b)
+      v = static_cast<T>(i++ % 5) - T(2);
+  }
+
+  r.template run<naive_adapter, T, 2>("gemm", shape, [&] {
+    for (size_type i = 0; i < size; ++i)
+      for (size_type j = 0; j < size; ++j) {
+        T sum = T();
+        for (size_type p = 0; p < size; ++p)
+          sum += a[i][p] * b[p][j];
+        c[i][j] = sum;
+      }
+    do_not_optimize(c);
+  });
+
+  r.template run<linalg_adapter, T, 2>("gemm", shape, [&] {
+    hypervector_linalg::gemm(a, b, c);
+    do_not_optimize(c);
+  });
+
+  hypervector<T, 1> x(size, T(1)), y(size, T());
+
+  r.template run<naive_adapter, T, 2>("gemv", shape, [&] {
+    for (size_type i = 0; i < size; ++i) {
+      T sum = T();
+      for (size_type j = 0; j < size; ++j)
+        sum += a[i][j] * x[j];
+      y[i] = sum;
+    }
+    do_not_optimize(y);
+  });
+
+  r.template run<linalg_adapter, T, 2>("gemv", shape, [&] {
+    hypervector_linalg::gemv(a, x, y);
+    do_not_optimize(y);
+  });
+}
+
+
+struct compressed_adapter
+{
+  static constexpr const char* name = "hypervector_compressed";
+};
+
+
+template<typename T>
+void bench_compressed(runner& r, const shape_t<3>& shape) {
+  if (!r.template selected<hypervector_adapter, T, 3>({"scan"}) &&
+      !r.template selected<compressed_adapter, T, 3>({"scan", "slice_iterate", "compress"}))
+    return;
+
+  auto hvec = hypervector_adapter::construct(shape, T());
+  for (size_type x = 0; x < shape[0]; ++x)
+    for (size_type y = 0; y < shape[1]; ++y)
+      for (size_type z = 0; z < shape[2]; ++z)
+        hvec.at(x, y, z) = static_cast<T>(280.0 + 10.0 * std::sin(0.05 * x) * std::cos(0.03 * y) + 0.1 * z);
+  const hypervector_compressed<T, 3> compressed(hvec);
+
+  r.template run<hypervector_adapter, T, 3>("scan", shape, [&] {
+    T sum = T();
+    for (auto v : hvec)
+      sum += v;
+    do_not_optimize(sum);
+  });
+
+  r.template run<compressed_adapter, T, 3>("scan", shape, [&] {
+    T sum = T();
+    compressed.for_each_block([&](size_type, const T* data, size_type count) {
+      for (size_type i = 0; i < count; ++i)
+        sum += data[i];
+    });
+    do_not_optimize(sum);
+  });
+
+  r.template run<compressed_adapter, T, 3>("slice_iterate", shape, [&] {
+    T sum = T();
+    for (size_type i = 0; i < shape[0]; ++i)
+      for (auto v : compressed.slice(i))
+        sum += v;
+    do_not_optimize(sum);
+  });
+
+  r.template run<compressed_adapter, T, 3>("compress", shape, [&] {
+    hypervector_compressed<T, 3> c(hvec);
+    do_not_optimize(c);
+  }, {
+    {"compressed_bytes", static_cast<double>(compressed.compressed_bytes())},
+    {"compression_ratio", static_cast<double>(compressed.uncompressed_bytes()) / static_cast<double>(std::max<size_type>(compressed.compressed_bytes(), 1))}
+  });
+}
+
+
+template<typename T>
+void bench_convert(runner& r, const shape_t<3>& shape) {
+  if (!r.template selected<naive_adapter, T, 3>({"convert_scaled"}) &&
+      !r.template selected<hypervector_adapter, T, 3>({"convert_scaled"}))
+    return;
+
+  hypervector<uint16_t, 3> raw(shape[0], shape[1], shape[2]);
+  {
+    size_type i = 0;
+    for (auto& v : raw)
+      v = static_cast<uint16_t>(i++ * 7);
+  }
+  hypervector<T, 3> hvec(shape[0], shape[1], shape[2]);
+
+  r.template run<naive_adapter, T, 3>("convert_scaled", shape, [&] {
+    for (size_type x = 0; x < shape[0]; ++x)
+      for (size_type y = 0; y < shape[1]; ++y)
+        for (size_type z = 0; z < shape[2]; ++z)
+          hvec.at(x, y, z) = static_cast<T>(raw.at(x, y, z)) * T(0.5) + T(1);
+    do_not_optimize(hvec);
+  });
+
+  r.template run<hypervector_adapter, T, 3>("convert_scaled", shape, [&] {
+    raw.convert_to(hvec, 0.5f, 1.0f);
+    do_not_optimize(hvec);
+  });
+}
+
+
+void usage(const char* argv0) {
+  std::cerr
+    << "usage: " << argv0 << " [--out=FILE] [--filter=SUBSTRING] [--repetitions=N] [--min-time-ms=N]\n"
+    << "  runs the hypervector benchmark suite and writes the results as JSON\n"
+    << "  benchmark keys are \"op/container/type/dims\", e.g. \"traverse_at/hypervector/int/3D\"\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  options opts;
+  for (int i = 1; i < argc; ++i) {
+    auto arg = std::string(argv[i]);
+    auto value_of = [&](const char* prefix) -> const char* {
+      auto len = std::char_traits<char>::length(prefix);
+      return (arg.compare(0, len, prefix) == 0 ? argv[i] + len : nullptr);
+    };
+
+    if (auto v = value_of("--out=")) {
+      opts.out = v;
+    } else if (auto v = value_of("--filter=")) {
+      opts.filter = v;
+    } else if (auto v = value_of("--repetitions=")) {
+      opts.repetitions = std::max<size_type>(std::strtoul(v, nullptr, 10), 1);
+    } else if (auto v = value_of("--min-time-ms=")) {
+      opts.min_time = std::chrono::milliseconds(std::strtoul(v, nullptr, 10));
+    } else {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  runner r(opts);
+  bench_all<int>(r);
+  bench_all<double>(r);
+  bench_all<std::string>(r);
+  bench_linalg<float>(r, 256);
+  bench_linalg<double>(r, 256);
+  bench_compressed<float>(r, {64, 128, 128});
+  bench_convert<float>(r, {64, 128, 128});
+
+  if (opts.out.empty()) {
+    r.write_json(std::cout);
+  } else {
+    std::ofstream ofs(opts.out);
+    if (!ofs) {
+      std::cerr << "failed to open " << opts.out << "\n";
+      return EXIT_FAILURE;
+    }
+    r.write_json(ofs);
+  }
+
+  return EXIT_SUCCESS;
+}
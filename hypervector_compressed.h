@@ -0,0 +1,532 @@
+#ifndef HYPERVECTOR_COMPRESSED_H
+#define HYPERVECTOR_COMPRESSED_H
+
+#include "hypervector_container.h"
+#include "hypervector_detail.h"
+#include "hypervector_ref.h"
+#include "hypervector_view.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace hypervector_detail {
+
+template<size_t Size>
+struct unsigned_of;
+
+template<>
+struct unsigned_of<1> { using type = std::uint8_t; };
+
+template<>
+struct unsigned_of<2> { using type = std::uint16_t; };
+
+template<>
+struct unsigned_of<4> { using type = std::uint32_t; };
+
+template<>
+struct unsigned_of<8> { using type = std::uint64_t; };
+
+
+// byte b of element i goes to plane b, i.e. out[b * count + i];
+// index sequences unroll over the bytes as the optimizer might not
+template<typename U, size_t ...B>
+void scatter_bytes_(U value, std::uint8_t* out, size_type count, size_type i, std::index_sequence<B...>) noexcept {
+  ((out[B * count + i] = static_cast<std::uint8_t>(value >> (8 * B))), ...);
+}
+
+template<typename U, size_t ...B>
+U gather_bytes_(const std::uint8_t* in, size_type count, size_type i, std::index_sequence<B...>) noexcept {
+  return static_cast<U>((static_cast<U>(static_cast<U>(in[B * count + i]) << (8 * B)) | ...));
+}
+
+
+// filter: zigzag-encoded deltas of the elements' bit patterns split into byte
+// planes, i.e. smooth data turns into long runs of (near) zero high bytes
+template<typename T>
+void delta_shuffle(const T* in, size_type count, std::uint8_t* out) noexcept {
+  using U = typename unsigned_of<sizeof(T)>::type;
+  constexpr unsigned bits = sizeof(U) * 8;
+
+  U prev = 0;
+  for (size_type i = 0; i < count; ++i) {
+    U curr;
+    std::memcpy(&curr, in + i, sizeof(U));
+    U delta = static_cast<U>(curr - prev);
+    prev = curr;
+    U zigzag = static_cast<U>(static_cast<U>(delta << 1) ^ static_cast<U>(U(0) - (delta >> (bits - 1))));
+    scatter_bytes_(zigzag, out, count, i, std::make_index_sequence<sizeof(U)>());
+  }
+}
+
+template<typename T>
+void delta_unshuffle(const std::uint8_t* in, size_type count, T* out) noexcept {
+  using U = typename unsigned_of<sizeof(T)>::type;
+  static_assert(sizeof(U) == sizeof(T), "delta_unshuffle");
+
+  // two passes per chunk: gathering the byte planes vectorizes, undoing the deltas can't
+  constexpr size_type chunk = 256;
+  U zigzag[chunk];
+  U prev = 0;
+  for (size_type first = 0; first < count; first += chunk) {
+    auto n = std::min(chunk, count - first);
+    for (size_type i = 0; i < n; ++i)
+      zigzag[i] = gather_bytes_<U>(in, count, first + i, std::make_index_sequence<sizeof(U)>());
+
+    for (size_type i = 0; i < n; ++i) {
+      U delta = static_cast<U>((zigzag[i] >> 1) ^ static_cast<U>(U(0) - (zigzag[i] & 1)));
+      prev = static_cast<U>(prev + delta);
+      zigzag[i] = prev;
+    }
+    std::memcpy(static_cast<void*>(out + first), zigzag, n * sizeof(U));
+  }
+}
+
+
+// byte-oriented LZ77 in the spirit of the LZ4 block format:
+// token (literal length << 4 | match length - 4), extended lengths as
+// 255-runs, literals, 16 bit little-endian match offset; the final
+// sequence consists of literals only
+namespace lz {
+
+constexpr size_type min_match = 4;
+constexpr size_type max_offset = 65535;
+constexpr unsigned hash_bits = 12;
+
+inline std::uint32_t read32(const std::uint8_t* p) noexcept {
+  std::uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline std::uint32_t hash(std::uint32_t v) noexcept {
+  return (v * 2654435761u) >> (32 - hash_bits);
+}
+
+inline void write_length(std::vector<std::uint8_t>& out, size_type length) {
+  for (; length >= 255; length -= 255)
+    out.push_back(255);
+  out.push_back(static_cast<std::uint8_t>(length));
+}
+
+inline void write_sequence(
+    std::vector<std::uint8_t>& out,
+    const std::uint8_t* literals, size_type literal_length,
+    size_type offset, size_type match_length) {
+  auto lit = std::min<size_type>(literal_length, 15);
+  auto mat = (match_length ? std::min<size_type>(match_length - min_match, 15) : 0);
+  out.push_back(static_cast<std::uint8_t>(lit << 4 | mat));
+  if (lit == 15)
+    write_length(out, literal_length - 15);
+  out.insert(out.end(), literals, literals + literal_length);
+  if (match_length) {
+    out.push_back(static_cast<std::uint8_t>(offset));
+    out.push_back(static_cast<std::uint8_t>(offset >> 8));
+    if (mat == 15)
+      write_length(out, match_length - min_match - 15);
+  }
+}
+
+inline void compress(const std::uint8_t* in, size_type size, std::vector<std::uint8_t>& out) {
+  out.clear();
+  std::vector<std::uint32_t> table(size_type(1) << hash_bits, 0); // position + 1; 0 is empty
+
+  size_type anchor = 0;
+  size_type pos = 0;
+  while (pos + min_match <= size) {
+    auto seq = read32(in + pos);
+    auto& entry = table[hash(seq)];
+    auto candidate = entry;
+    entry = static_cast<std::uint32_t>(pos + 1);
+
+    if (candidate && pos - (candidate - 1) <= max_offset && read32(in + candidate - 1) == seq) {
+      auto match = candidate - 1;
+      auto length = min_match;
+      while (pos + length < size && in[match + length] == in[pos + length])
+        ++length;
+      write_sequence(out, in + anchor, pos - anchor, pos - match, length);
+      pos += length;
+      anchor = pos;
+    } else {
+      // skip faster through incompressible data
+      pos += 1 + ((pos - anchor) >> 6);
+    }
+  }
+  write_sequence(out, in + anchor, size - anchor, 0, 0);
+}
+
+inline bool read_length(const std::uint8_t*& in, const std::uint8_t* end, size_type& length) noexcept {
+  std::uint8_t v;
+  do {
+    if (in == end)
+      return false;
+    v = *in++;
+    length += v;
+  } while (v == 255);
+  return true;
+}
+
+inline bool decompress(const std::uint8_t* in, size_type in_size, std::uint8_t* out, size_type out_size) noexcept {
+  const auto in_end = in + in_size;
+  const auto out_begin = out;
+  const auto out_end = out + out_size;
+  while (in < in_end) {
+    auto token = *in++;
+
+    size_type literal_length = token >> 4;
+    if (literal_length == 15 && !read_length(in, in_end, literal_length))
+      return false;
+    if (literal_length > size_type(in_end - in) || literal_length > size_type(out_end - out))
+      return false;
+    std::memcpy(out, in, literal_length);
+    in += literal_length;
+    out += literal_length;
+    if (in == in_end)
+      break;
+
+    if (in_end - in < 2)
+      return false;
+    size_type offset = in[0] | size_type(in[1]) << 8;
+    in += 2;
+    size_type match_length = token & 15;
+    if (match_length == 15 && !read_length(in, in_end, match_length))
+      return false;
+    match_length += min_match;
+    if (offset == 0 || offset > size_type(out - out_begin) || match_length > size_type(out_end - out))
+      return false;
+
+    const std::uint8_t* match = out - offset;
+    if (offset >= match_length) {
+      std::memcpy(out, match, match_length);
+      out += match_length;
+    } else {
+      // overlapping, i.e. a repeated pattern: copy the growing periodic run
+      while (match_length) {
+        auto n = std::min<size_type>(out - match, match_length);
+        std::memcpy(out, match, n);
+        out += n;
+        match_length -= n;
+      }
+    }
+  }
+  return (out == out_end);
+}
+
+} // namespace lz
+
+} // namespace hypervector_detail
+
+/// read-only hypervector holding its data in independently compressed blocks
+///
+/// blocks are filtered (delta + byte shuffle) and LZ-compressed; random
+/// access via at() and slice() goes through an LRU cache of decompressed
+/// blocks while for_each_block() decodes sequentially without caching
+template<typename T, size_t Dims>
+struct hypervector_compressed
+{
+  static_assert(std::is_trivially_copyable<T>::value,
+    "hypervector_compressed requires trivially copyable elements");
+  static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8,
+    "hypervector_compressed requires elements of 1, 2, 4 or 8 bytes");
+
+  using value_type = T;
+  using size_type = hypervector_detail::size_type;
+  using block_storage = std::shared_ptr<const std::vector<T>>;
+
+  static constexpr size_type default_block_size = 16384; ///< elements per block
+  static constexpr size_t default_cache_blocks = 8; ///< decompressed blocks kept
+
+  /// view on a decompressed slice that keeps its block(s) alive
+  struct slice_view : public hypervector_ref<T, Dims - 1, true>
+  {
+    using ref = hypervector_ref<T, Dims - 1, true>;
+
+    slice_view(block_storage storage, const ref& r)
+      : ref(r)
+      , storage_(std::move(storage)) {
+    }
+
+  private:
+    block_storage storage_; ///< decompressed data the ref points to
+  };
+
+private:
+  struct block
+  {
+    std::vector<std::uint8_t> bytes; ///< compressed or, if raw, verbatim element bytes
+    bool raw; ///< not compressible
+  };
+
+  struct cache_entry
+  {
+    size_type index;
+    block_storage storage;
+    size_type last_use;
+  };
+
+  // LRU cache of decompressed blocks, held by pointer to keep the container movable
+  struct block_cache
+  {
+    std::mutex mutex; ///< guards the cache for concurrent readers
+    std::vector<cache_entry> entries;
+    size_type tick = 0; ///< use counter for LRU
+  };
+
+  hypervector_detail::dimension dims_[Dims]; ///< shape and stride of dimensions
+  size_type block_size_; ///< elements per block (except for the last one)
+  std::vector<block> blocks_; ///< independently compressed blocks
+  size_t cache_blocks_; ///< maximum number of cached decompressed blocks
+
+  std::unique_ptr<block_cache> cache_; ///< mutable through the pointer
+
+public:
+  /// compress the contents of given view (or container)
+  template<bool IsConst>
+  explicit hypervector_compressed(
+      const hypervector_view<T, Dims, IsConst>& src,
+      size_type block_size = default_block_size,
+      size_t cache_blocks = default_cache_blocks)
+    : block_size_(std::max<size_type>(block_size, 1))
+    , cache_blocks_(std::max<size_t>(cache_blocks, 1))
+    , cache_(std::make_unique<block_cache>()) {
+    std::copy_n(src.dims_, Dims, dims_);
+
+    auto total = size();
+    blocks_.reserve((total + block_size_ - 1) / block_size_);
+    std::vector<std::uint8_t> filtered(std::min(total, block_size_) * sizeof(T));
+    for (size_type first = 0; first < total; first += block_size_) {
+      auto count = std::min(block_size_, total - first);
+      hypervector_detail::delta_shuffle(src.begin() + first, count, filtered.data());
+
+      block b;
+      hypervector_detail::lz::compress(filtered.data(), count * sizeof(T), b.bytes);
+      b.raw = (b.bytes.size() >= count * sizeof(T));
+      if (b.raw) {
+        auto bytes = reinterpret_cast<const std::uint8_t*>(src.begin() + first);
+        b.bytes.assign(bytes, bytes + count * sizeof(T));
+      }
+      b.bytes.shrink_to_fit();
+      blocks_.push_back(std::move(b));
+    }
+  }
+
+
+  hypervector_compressed(const hypervector_compressed&) = delete;
+  hypervector_compressed& operator=(const hypervector_compressed&) = delete;
+
+
+  /// the moved-from object may only be destroyed or assigned to
+  hypervector_compressed(hypervector_compressed&&) noexcept = default;
+  hypervector_compressed& operator=(hypervector_compressed&&) noexcept = default;
+
+
+  // value_type at(size_type pos...) const
+  /// element at given indices, decompressing (and caching) its block if necessary
+  template<typename ...Indices>
+  typename std::enable_if<sizeof...(Indices) == Dims, value_type>::type
+  at(Indices&&... indices) const {
+    const size_type index[Dims] = {static_cast<size_type>(indices)...};
+    size_type pos = 0;
+    for (size_t dim = 0; dim < Dims; ++dim) {
+      if (index[dim] >= dims_[dim].size)
+        throw std::out_of_range("hypervector_compressed::at");
+      pos += index[dim] * dims_[dim].offset;
+    }
+    auto storage = cached_(pos / block_size_);
+    return (*storage)[pos % block_size_];
+  }
+
+
+  /// view on the subdimension at given index of the outer dimension;
+  /// shares the cached block if the slice lies within one, otherwise
+  /// decompresses the slice into storage of its own
+  template<size_t Dims_ = Dims,
+           typename = typename std::enable_if<(Dims_ > 1)>::type>
+  slice_view slice(size_type pos) const {
+    if (pos >= dims_[0].size)
+      throw std::out_of_range("hypervector_compressed::slice");
+
+    auto slice_size = dims_[0].offset;
+    if (slice_size == 0) // empty slices have no block to refer to
+      return slice_view(nullptr, slice_ref_(nullptr, std::make_index_sequence<Dims - 1>()));
+
+    auto first = pos * slice_size;
+    auto first_block = first / block_size_;
+    if ((first + slice_size - 1) / block_size_ == first_block) {
+      auto storage = cached_(first_block);
+      auto data = storage->data() + first % block_size_;
+      return slice_view(std::move(storage), slice_ref_(data, std::make_index_sequence<Dims - 1>()));
+    }
+
+    auto storage = std::make_shared<std::vector<T>>(slice_size);
+    decode_(first, slice_size, storage->data());
+    auto data = storage->data();
+    return slice_view(std::move(storage), slice_ref_(data, std::make_index_sequence<Dims - 1>()));
+  }
+
+
+  /// decode all blocks in sequence without going through the cache;
+  /// f(first, data, count) is called with the position of the block's first
+  /// element and the block's decompressed elements. Decoding runs on the
+  /// calling thread, i.e. scans are bound by the single-threaded decode rate
+  template<typename F>
+  void for_each_block(F&& f) const {
+    std::vector<T> values(std::min(size(), block_size_));
+    std::vector<std::uint8_t> scratch(values.size() * sizeof(T));
+    for (size_type b = 0; b < blocks_.size(); ++b) {
+      auto first = b * block_size_;
+      auto count = std::min(block_size_, size() - first);
+      decode_block_(b, count, values.data(), scratch.data());
+      f(first, static_cast<const T*>(values.data()), count);
+    }
+  }
+
+
+  /// decompress into a regular container
+  hypervector<T, Dims> decompress() const {
+    hypervector<T, Dims> hvec = make_(std::make_index_sequence<Dims>());
+    decode_(0, size(), hvec.data());
+    return hvec;
+  }
+
+
+  size_type size() const noexcept {
+    return dims_[0].offset * dims_[0].size;
+  }
+
+
+  bool empty() const noexcept {
+    return (size() == 0);
+  }
+
+
+  template<size_type Dim>
+  size_type sizeOf() const noexcept {
+    static_assert(Dim < Dims, "hypervector_compressed::sizeOf");
+    return dims_[Dim].size;
+  }
+
+
+  size_type block_size() const noexcept {
+    return block_size_;
+  }
+
+
+  size_type block_count() const noexcept {
+    return blocks_.size();
+  }
+
+
+  /// bytes held by the compressed blocks (excluding the cache)
+  size_type compressed_bytes() const noexcept {
+    size_type bytes = 0;
+    for (auto&& b : blocks_)
+      bytes += b.bytes.size();
+    return bytes;
+  }
+
+
+  /// bytes the data would take uncompressed
+  size_type uncompressed_bytes() const noexcept {
+    return size() * sizeof(T);
+  }
+
+private:
+  template<size_t ...Dim>
+  hypervector<T, Dims> make_(std::index_sequence<Dim...>) const {
+    return hypervector<T, Dims>(dims_[Dim].size..., T());
+  }
+
+
+  template<size_t ...Dim>
+  hypervector_ref<T, Dims - 1, true> slice_ref_(const T* data, std::index_sequence<Dim...>) const {
+    return hypervector_ref<T, Dims - 1, true>(data, dims_[Dim + 1].size...);
+  }
+
+
+  void decode_block_(size_type index, size_type count, T* out, std::uint8_t* scratch) const {
+    auto&& b = blocks_[index];
+    if (b.raw) {
+      std::memcpy(static_cast<void*>(out), b.bytes.data(), count * sizeof(T));
+      return;
+    }
+    if (!hypervector_detail::lz::decompress(b.bytes.data(), b.bytes.size(), scratch, count * sizeof(T)))
+      throw std::runtime_error("hypervector_compressed: corrupt block");
+    hypervector_detail::delta_unshuffle(scratch, count, out);
+  }
+
+
+  // decode count elements starting at element first into out
+  void decode_(size_type first, size_type count, T* out) const {
+    std::vector<T> values;
+    std::vector<std::uint8_t> scratch(std::min(size(), block_size_) * sizeof(T));
+    for (auto last = first + count; first < last;) {
+      auto b = first / block_size_;
+      auto block_first = b * block_size_;
+      auto block_count = std::min(block_size_, size() - block_first);
+      auto n = std::min(last, block_first + block_count) - first;
+      if (first == block_first && n == block_count) {
+        decode_block_(b, block_count, out, scratch.data()); // whole block in place
+      } else {
+        values.resize(block_count);
+        decode_block_(b, block_count, values.data(), scratch.data());
+        std::copy_n(values.data() + (first - block_first), n, out);
+      }
+      out += n;
+      first += n;
+    }
+  }
+
+
+  // cached block or, on a miss, the block decoded outside the lock so that
+  // concurrent readers of other (cached) blocks do not wait for the decode
+  block_storage cached_(size_type index) const {
+    auto&& cache = *cache_;
+    {
+      std::lock_guard<std::mutex> lock(cache.mutex);
+      if (auto storage = lookup_(index))
+        return storage;
+    }
+
+    auto count = std::min(block_size_, size() - index * block_size_);
+    auto values = std::make_shared<std::vector<T>>(count);
+    std::vector<std::uint8_t> scratch(count * sizeof(T));
+    decode_block_(index, count, values->data(), scratch.data());
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    if (auto storage = lookup_(index)) // inserted by a concurrent miss meanwhile
+      return storage;
+    if (cache.entries.size() < cache_blocks_) {
+      cache.entries.push_back(cache_entry{index, values, cache.tick});
+    } else {
+      auto lru = std::min_element(cache.entries.begin(), cache.entries.end(), [](const cache_entry& lhs, const cache_entry& rhs) {
+        return lhs.last_use < rhs.last_use;
+      });
+      *lru = cache_entry{index, values, cache.tick};
+    }
+    return values;
+  }
+
+
+  // cached block marked as most recently used; requires the cache mutex
+  block_storage lookup_(size_type index) const {
+    auto&& cache = *cache_;
+    ++cache.tick;
+    for (auto&& entry : cache.entries) {
+      if (entry.index == index) {
+        entry.last_use = cache.tick;
+        return entry.storage;
+      }
+    }
+    return nullptr;
+  }
+};
+
+#endif // HYPERVECTOR_COMPRESSED_H
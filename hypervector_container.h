@@ -2,6 +2,8 @@
 #define HYPERVECTOR_CONTAINER_H
 
 #include "hypervector_detail.h"
+#include "hypervector_instrumentation.h"
+#include "hypervector_ref.h" // for hypervector_view::reshape()
 #include "hypervector_view.h"
 
 #include <algorithm>
@@ -21,6 +23,7 @@ struct hypervector : public hypervector_view<T, Dims, false>
 private:
   // uses the view's members for access to shape and values
   size_type capacity_; ///< pre-allocated memory managed via reserve()
+  [[no_unique_address]] hypervector_detail::instrument<T, Dims> instrument_; ///< no-op unless HYPERVECTOR_INSTRUMENTATION
 
 public:
   /// create empty container
@@ -39,6 +42,7 @@ public:
       Sizes&&... sizes)
     : hypervector() {
     (void)assign_(0, 1, size0, std::forward<Sizes>(sizes)...);
+    instrument_.resized(view::size());
   }
 
 
@@ -51,6 +55,7 @@ public:
       Sizes&&... sizes)
     : hypervector() {
     (void)assign_(0, 1, size0, std::forward<Sizes>(sizes)..., T());
+    instrument_.resized(view::size());
   }
 
 
@@ -61,6 +66,7 @@ public:
     : hypervector() {
     reserve_(0, list_check_<0>(init));
     (void)list_init_<0>(0, std::move(init));
+    instrument_.resized(view::size());
   }
 
 
@@ -75,6 +81,8 @@ public:
     reserve_(0, other.size());
     std::uninitialized_copy_n(other.begin(), other.size(), view::begin()); // XXX unsafe if throws halfway in
     std::copy_n(other.dims_, Dims, view::dims_);
+    instrument_.copied(other.size());
+    instrument_.resized(view::size());
   }
 
 
@@ -86,7 +94,9 @@ public:
 
   ~hypervector() {
     std::destroy_n(view::begin(), view::size());
+    instrument_.destroyed(view::size());
     deallocate_(view::begin(), capacity());
+    instrument_.released();
     delete[] view::dims_;
   }
 
@@ -102,6 +112,8 @@ public:
     reserve_(0, other.size());
     std::uninitialized_copy_n(other.begin(), other.size(), view::begin()); // XXX unsafe if throws halfway in
     std::copy_n(other.dims_, Dims, view::dims_);
+    instrument_.copied(other.size());
+    instrument_.resized(view::size());
     return *this;
   }
 
@@ -122,6 +134,7 @@ public:
       size_type size0,
       Sizes&&... sizes) {
     (void)resize_(view::size(), 1, size0, std::forward<Sizes>(sizes)...);
+    instrument_.resized(view::size());
   }
 
 
@@ -134,6 +147,7 @@ public:
       size_type size0,
       Sizes&&... sizes) {
     (void)resize_(view::size(), 1, size0, std::forward<Sizes>(sizes)..., T());
+    instrument_.resized(view::size());
   }
 
 
@@ -146,12 +160,14 @@ public:
       size_type size0,
       Sizes&&... sizes) {
     (void)assign_(view::size(), 1, size0, std::forward<Sizes>(sizes)...);
+    instrument_.resized(view::size());
   }
 
 
   /// destroy contents and set dimension sizes to zero
   void clear() {
     clear_(view::size());
+    instrument_.resized(0);
   }
 
 
@@ -174,6 +190,22 @@ public:
   }
 
 private:
+  // create container with the dense shape of given dimensions whose elements
+  // construct(data) creates in uninitialized storage, e.g. for hypervector_view::convert()
+  template<typename F>
+  hypervector(
+      const hypervector_detail::dimension* dims,
+      F&& construct)
+    : hypervector() {
+    auto size = dims[0].offset * dims[0].size;
+    reserve_(0, size);
+    construct(view::begin());
+    std::copy_n(dims, Dims, view::dims_);
+    instrument_.constructed(size);
+    instrument_.resized(size);
+  }
+
+
   struct deallocator
   {
     size_type size;
@@ -217,8 +249,10 @@ private:
     if (new_size > old_size) {
       reserve_(old_size, new_size);
       std::uninitialized_fill_n(view::begin() + old_size, new_size - old_size, val); // XXX unsafe if throws halfway in
+      instrument_.constructed(new_size - old_size);
     } else if (old_size > new_size) {
       std::destroy_n(view::begin() + new_size, old_size - new_size);
+      instrument_.destroyed(old_size - new_size);
     }
     return 1;
   }
@@ -245,12 +279,14 @@ private:
     clear_(old_size);
     reserve_(0, new_size);
     std::uninitialized_fill_n(view::begin(), new_size, val); // XXX unsafe if throws halfway in
+    instrument_.constructed(new_size);
     return 1;
   }
 
 
   void clear_(size_type old_size) {
     std::destroy_n(view::begin(), old_size);
+    instrument_.destroyed(old_size);
     std::fill_n(view::dims_, Dims, hypervector_detail::dimension());
   }
 
@@ -277,6 +313,7 @@ private:
     deallocate_(view::vals_, capacity_);
     view::vals_ = new_vals.release();
     capacity_ = new_capacity;
+    instrument_.reserved(old_size, new_capacity);
   }
 
 
@@ -331,6 +368,7 @@ private:
 
     auto size = init.size();
     std::uninitialized_move_n(init.begin(), size, view::begin() + offset); // XXX unsafe if throws
+    instrument_.moved(size);
     view::dims_[Dim].offset = 1;
     view::dims_[Dim].size = size;
     return size;
@@ -339,6 +377,10 @@ private:
 
   template<typename U, size_t Dim>
   friend void swap(hypervector<U, Dim>&, hypervector<U, Dim>&) noexcept;
+
+  // friend declaration for hypervector_view's convert()
+  template<typename, size_t, bool>
+  friend struct hypervector_view;
 };
 
 template<typename T, size_t Dims>
@@ -348,6 +390,7 @@ void swap(hypervector<T, Dims>& lhs, hypervector<T, Dims>& rhs) noexcept
   swap(lhs.dims_, rhs.dims_);
   swap(lhs.vals_, rhs.vals_);
   swap(lhs.capacity_, rhs.capacity_);
+  lhs.instrument_.swap(rhs.instrument_);
 }
 
 #endif // HYPERVECTOR_CONTAINER_H
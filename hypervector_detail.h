@@ -1,7 +1,12 @@
 #ifndef HYPERVECTOR_DETAIL_H
 #define HYPERVECTOR_DETAIL_H
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
 
 namespace hypervector_detail {
 
@@ -14,6 +19,96 @@ struct dimension {
   bool operator==(const dimension&) const noexcept = default;
 };
 
+
+// arithmetic type of scaled conversions from T to U;
+// float where it holds both exactly, e.g. for 8/16 bit sensor data, else double
+template<typename T, typename U>
+using convert_type = typename std::conditional<
+  (std::is_same<T, float>::value || (std::is_integral<T>::value && sizeof(T) <= 2)) &&
+  (std::is_same<U, float>::value || (std::is_integral<U>::value && sizeof(U) <= 2)),
+  float,
+  double>::type;
+
+
+// largest value of floating point type C not above the maximum of integral U
+template<typename C, typename U>
+C saturation_max_() noexcept {
+  auto max = static_cast<C>(std::numeric_limits<U>::max());
+  if constexpr (std::numeric_limits<U>::digits > std::numeric_limits<C>::digits)
+    max = std::nextafter(max, C(0)); // max rounded up to the next power of 2
+  return max;
+}
+
+
+// dst[i] = U(f(src[i])) for f yielding floating point values, saturated if U is integral;
+// NaN yields the minimum of U
+template<typename T, typename U, typename F>
+void saturate_n_(const T* src, size_type count, U* dst, F f) noexcept {
+  using C = decltype(f(*src));
+  if constexpr (std::is_integral<U>::value) {
+    const auto lo = static_cast<C>(std::numeric_limits<U>::lowest());
+    const auto hi = saturation_max_<C, U>();
+    if constexpr (std::numeric_limits<U>::digits > std::numeric_limits<C>::digits) {
+      // hi is below the maximum of U; values from 2^digits on map to the maximum
+      const auto limit = static_cast<C>(std::numeric_limits<U>::max());
+      for (size_type i = 0; i < count; ++i) {
+        const auto val = f(src[i]);
+        dst[i] = val >= limit ? std::numeric_limits<U>::max() : static_cast<U>(std::max(lo, std::min(val, hi)));
+      }
+    } else {
+      for (size_type i = 0; i < count; ++i)
+        dst[i] = static_cast<U>(std::max(lo, std::min(f(src[i]), hi)));
+    }
+  } else {
+    for (size_type i = 0; i < count; ++i)
+      dst[i] = static_cast<U>(f(src[i]));
+  }
+}
+
+
+// a < b for integers of different signedness (std::cmp_less without its type restrictions)
+template<typename A, typename B>
+constexpr bool cmp_less_(A a, B b) noexcept {
+  if constexpr (std::is_signed<A>::value == std::is_signed<B>::value)
+    return a < b;
+  else if constexpr (std::is_signed<A>::value)
+    return a < 0 || static_cast<typename std::make_unsigned<A>::type>(a) < b;
+  else
+    return b >= 0 && a < static_cast<typename std::make_unsigned<B>::type>(b);
+}
+
+
+// dst[i] = U(src[i]), saturated if U is integral
+template<typename T, typename U>
+void convert_n_(const T* src, size_type count, U* dst) noexcept {
+  if constexpr (std::is_integral<T>::value && std::is_integral<U>::value) {
+    using t_limits = std::numeric_limits<T>;
+    using u_limits = std::numeric_limits<U>;
+    if constexpr (!cmp_less_(t_limits::lowest(), u_limits::lowest()) && !cmp_less_(u_limits::max(), t_limits::max())) {
+      for (size_type i = 0; i < count; ++i)
+        dst[i] = static_cast<U>(src[i]);
+    } else {
+      // clamp in T, where both bounds of U that lie in its range are exact
+      constexpr T lo = cmp_less_(t_limits::lowest(), u_limits::lowest()) ? static_cast<T>(u_limits::lowest()) : t_limits::lowest();
+      constexpr T hi = cmp_less_(u_limits::max(), t_limits::max()) ? static_cast<T>(u_limits::max()) : t_limits::max();
+      for (size_type i = 0; i < count; ++i)
+        dst[i] = static_cast<U>(std::max(lo, std::min(src[i], hi)));
+    }
+  } else if constexpr (std::is_floating_point<T>::value) {
+    saturate_n_(src, count, dst, [](T val) { return val; });
+  } else {
+    for (size_type i = 0; i < count; ++i)
+      dst[i] = static_cast<U>(src[i]);
+  }
+}
+
+
+// dst[i] = U(src[i] * scale + offset), computed in C and saturated if U is integral
+template<typename T, typename U, typename C>
+void convert_n_(const T* src, size_type count, U* dst, C scale, C offset) noexcept {
+  saturate_n_(src, count, dst, [scale, offset](T val) { return static_cast<C>(val) * scale + offset; });
+}
+
 } // namespace hypervector_detail
 
 #endif // HYPERVECTOR_DETAIL_H
@@ -0,0 +1,350 @@
+#ifndef HYPERVECTOR_INSTRUMENTATION_H
+#define HYPERVECTOR_INSTRUMENTATION_H
+
+#include "hypervector_detail.h"
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#ifdef HYPERVECTOR_INSTRUMENTATION
+# include <algorithm>
+# include <atomic>
+# include <mutex>
+# include <typeinfo>
+#endif
+
+// opt-in allocation and access counters of hypervector containers
+//
+// define HYPERVECTOR_INSTRUMENTATION (consistently for all translation units,
+// e.g. via the CMake option of the same name) to enable; otherwise all hooks
+// compile to nothing and the container layout is unchanged
+namespace hypervector_instrumentation {
+
+using size_type = hypervector_detail::size_type;
+
+#ifdef HYPERVECTOR_INSTRUMENTATION
+constexpr bool enabled = true;
+#else
+constexpr bool enabled = false;
+#endif
+
+/// process-wide counters accumulated over all containers
+struct statistics
+{
+  size_type allocations = 0; ///< storage blocks allocated by reserve()
+  size_type deallocations = 0; ///< storage blocks released
+  size_type reallocations = 0; ///< allocations that replaced a previous block
+  size_type bytes_allocated = 0; ///< cumulative bytes allocated
+  size_type bytes_reserved = 0; ///< bytes currently allocated by live containers
+  size_type bytes_reserved_peak = 0; ///< high-water mark of bytes_reserved
+  size_type elements_constructed = 0; ///< elements constructed from a value
+  size_type elements_copied = 0; ///< elements copy-constructed from another container
+  size_type elements_moved = 0; ///< elements move-constructed, e.g. on reallocation
+  size_type elements_destroyed = 0; ///< elements destroyed, including moved-from ones
+  size_type grids_live = 0; ///< containers currently alive
+  size_type grids_peak = 0; ///< high-water mark of grids_live
+  size_type accesses_at = 0; ///< elements accessed via (bounds-checked) at()
+  size_type accesses_subscript = 0; ///< elements accessed via operator[] of the last dimension
+};
+
+/// state of an individual live container
+struct grid
+{
+  const void* address; ///< address of the container's instrumentation record
+  const char* type; ///< implementation-defined name of the element type
+  size_t dims; ///< number of dimensions
+  size_type element_size; ///< sizeof element type
+  size_type size; ///< current number of elements, i.e. size()
+  size_type size_peak; ///< high-water mark of size
+  size_type capacity; ///< current number of allocated elements, i.e. capacity()
+};
+
+} // namespace hypervector_instrumentation
+
+namespace hypervector_detail {
+
+#ifdef HYPERVECTOR_INSTRUMENTATION
+
+class instrument_base
+{
+public:
+  struct counters
+  {
+    std::atomic<size_type> allocations{0};
+    std::atomic<size_type> deallocations{0};
+    std::atomic<size_type> reallocations{0};
+    std::atomic<size_type> bytes_allocated{0};
+    std::atomic<size_type> bytes_reserved{0};
+    std::atomic<size_type> bytes_reserved_peak{0};
+    std::atomic<size_type> elements_constructed{0};
+    std::atomic<size_type> elements_copied{0};
+    std::atomic<size_type> elements_moved{0};
+    std::atomic<size_type> elements_destroyed{0};
+    std::atomic<size_type> grids_live{0};
+    std::atomic<size_type> grids_peak{0};
+    std::atomic<size_type> accesses_at{0};
+    std::atomic<size_type> accesses_subscript{0};
+  };
+
+  struct registry
+  {
+    std::mutex mutex;
+    std::vector<const instrument_base*> grids;
+  };
+
+  static counters& global() {
+    static counters instance;
+    return instance;
+  }
+
+  static registry& live() {
+    static registry instance;
+    return instance;
+  }
+
+protected:
+  instrument_base(const char* type, size_t dims, size_type element_size)
+    : type_(type)
+    , dims_(dims)
+    , element_size_(element_size) {
+    auto&& reg = live();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.grids.push_back(this);
+    auto& g = global();
+    update_peak_(g.grids_peak, ++g.grids_live);
+  }
+
+  ~instrument_base() {
+    // storage is released by the container before its members are destroyed
+    auto&& reg = live();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.grids.erase(std::find(reg.grids.begin(), reg.grids.end(), this));
+    --global().grids_live;
+  }
+
+  instrument_base(const instrument_base&) = delete;
+  instrument_base& operator=(const instrument_base&) = delete;
+
+public:
+  void reserved(size_type old_size, size_type new_capacity) noexcept {
+    auto& g = global();
+    auto old_capacity = capacity_.exchange(new_capacity, std::memory_order_relaxed);
+    if (old_capacity) {
+      ++g.reallocations;
+      ++g.deallocations;
+    }
+    ++g.allocations;
+    g.bytes_allocated += new_capacity * element_size_;
+    update_peak_(g.bytes_reserved_peak,
+      g.bytes_reserved += (new_capacity - old_capacity) * element_size_);
+    g.elements_moved += old_size;
+    g.elements_destroyed += old_size;
+  }
+
+  void released() noexcept {
+    auto& g = global();
+    auto old_capacity = capacity_.exchange(0, std::memory_order_relaxed);
+    if (old_capacity) {
+      ++g.deallocations;
+      g.bytes_reserved -= old_capacity * element_size_;
+    }
+  }
+
+  void constructed(size_type count) noexcept {
+    global().elements_constructed += count;
+  }
+
+  void copied(size_type count) noexcept {
+    global().elements_copied += count;
+  }
+
+  void moved(size_type count) noexcept {
+    global().elements_moved += count;
+  }
+
+  void destroyed(size_type count) noexcept {
+    global().elements_destroyed += count;
+  }
+
+  void resized(size_type size) noexcept {
+    size_.store(size, std::memory_order_relaxed);
+    update_peak_(size_peak_, size);
+  }
+
+  void swap(instrument_base& other) noexcept {
+    auto swap_ = [](std::atomic<size_type>& lhs, std::atomic<size_type>& rhs) {
+      rhs.store(
+        lhs.exchange(rhs.load(std::memory_order_relaxed), std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    };
+    swap_(size_, other.size_);
+    swap_(size_peak_, other.size_peak_);
+    swap_(capacity_, other.capacity_);
+  }
+
+  hypervector_instrumentation::grid info() const noexcept {
+    return {
+      this,
+      type_,
+      dims_,
+      element_size_,
+      size_.load(std::memory_order_relaxed),
+      size_peak_.load(std::memory_order_relaxed),
+      capacity_.load(std::memory_order_relaxed)
+    };
+  }
+
+private:
+  static void update_peak_(std::atomic<size_type>& peak, size_type value) noexcept {
+    auto prev = peak.load(std::memory_order_relaxed);
+    while (prev < value && !peak.compare_exchange_weak(prev, value, std::memory_order_relaxed));
+  }
+
+  const char* type_;
+  size_t dims_;
+  size_type element_size_;
+  std::atomic<size_type> size_{0};
+  std::atomic<size_type> size_peak_{0};
+  std::atomic<size_type> capacity_{0};
+};
+
+/// per-container instrumentation record registered in the global registry
+template<typename T, size_t Dims>
+struct instrument : public instrument_base
+{
+  instrument()
+    : instrument_base(typeid(T).name(), Dims, sizeof(T)) {
+  }
+};
+
+#else // HYPERVECTOR_INSTRUMENTATION
+
+/// no-op stand-in used when instrumentation is disabled
+template<typename T, size_t Dims>
+struct instrument
+{
+  void reserved(size_type, size_type) noexcept {}
+  void released() noexcept {}
+  void constructed(size_type) noexcept {}
+  void copied(size_type) noexcept {}
+  void moved(size_type) noexcept {}
+  void destroyed(size_type) noexcept {}
+  void resized(size_type) noexcept {}
+  void swap(instrument&) noexcept {}
+};
+
+#endif // HYPERVECTOR_INSTRUMENTATION
+
+// element access hooks of views; a relaxed increment of a process-wide counter
+// per access when enabled, i.e. expect instrumented traversals to be slower
+inline void accessed_at() noexcept {
+#ifdef HYPERVECTOR_INSTRUMENTATION
+  instrument_base::global().accesses_at.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+
+inline void accessed_subscript() noexcept {
+#ifdef HYPERVECTOR_INSTRUMENTATION
+  instrument_base::global().accesses_subscript.fetch_add(1, std::memory_order_relaxed);
+#endif
+}
+
+} // namespace hypervector_detail
+
+namespace hypervector_instrumentation {
+
+/// snapshot of the process-wide counters
+inline statistics snapshot() {
+  statistics stats;
+#ifdef HYPERVECTOR_INSTRUMENTATION
+  auto& g = hypervector_detail::instrument_base::global();
+  stats.allocations = g.allocations;
+  stats.deallocations = g.deallocations;
+  stats.reallocations = g.reallocations;
+  stats.bytes_allocated = g.bytes_allocated;
+  stats.bytes_reserved = g.bytes_reserved;
+  stats.bytes_reserved_peak = g.bytes_reserved_peak;
+  stats.elements_constructed = g.elements_constructed;
+  stats.elements_copied = g.elements_copied;
+  stats.elements_moved = g.elements_moved;
+  stats.elements_destroyed = g.elements_destroyed;
+  stats.grids_live = g.grids_live;
+  stats.grids_peak = g.grids_peak;
+  stats.accesses_at = g.accesses_at;
+  stats.accesses_subscript = g.accesses_subscript;
+#endif
+  return stats;
+}
+
+
+/// reset cumulative counters; peaks restart from the current live state
+inline void reset() {
+#ifdef HYPERVECTOR_INSTRUMENTATION
+  auto& g = hypervector_detail::instrument_base::global();
+  g.allocations = 0;
+  g.deallocations = 0;
+  g.reallocations = 0;
+  g.bytes_allocated = 0;
+  g.bytes_reserved_peak = g.bytes_reserved.load();
+  g.elements_constructed = 0;
+  g.elements_copied = 0;
+  g.elements_moved = 0;
+  g.elements_destroyed = 0;
+  g.grids_peak = g.grids_live.load();
+  g.accesses_at = 0;
+  g.accesses_subscript = 0;
+#endif
+}
+
+
+/// state of all currently live containers
+/// (values are exact only if no container is modified concurrently)
+inline std::vector<grid> grids() {
+  std::vector<grid> ret;
+#ifdef HYPERVECTOR_INSTRUMENTATION
+  auto&& reg = hypervector_detail::instrument_base::live();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  ret.reserve(reg.grids.size());
+  for (auto&& g : reg.grids)
+    ret.push_back(g->info());
+#endif
+  return ret;
+}
+
+
+/// human-readable dump of counters and live containers
+inline std::ostream& dump(std::ostream& os) {
+  if (!enabled)
+    return os << "hypervector instrumentation disabled\n";
+
+  auto stats = snapshot();
+  os << "hypervector instrumentation:\n"
+     << "  allocations: " << stats.allocations
+     << " (reallocations: " << stats.reallocations
+     << ", deallocations: " << stats.deallocations << ")\n"
+     << "  bytes allocated: " << stats.bytes_allocated
+     << ", reserved: " << stats.bytes_reserved
+     << " (peak: " << stats.bytes_reserved_peak << ")\n"
+     << "  elements constructed: " << stats.elements_constructed
+     << ", copied: " << stats.elements_copied
+     << ", moved: " << stats.elements_moved
+     << ", destroyed: " << stats.elements_destroyed << "\n"
+     << "  grids live: " << stats.grids_live
+     << " (peak: " << stats.grids_peak << ")\n"
+     << "  element accesses at(): " << stats.accesses_at
+     << ", operator[]: " << stats.accesses_subscript << "\n";
+
+  for (auto&& g : grids()) {
+    os << "  " << g.address << ": " << g.type << "[" << g.dims << "D]"
+       << " size: " << g.size << " (peak: " << g.size_peak << ")"
+       << " capacity: " << g.capacity
+       << " bytes used/reserved: " << g.size * g.element_size
+       << "/" << g.capacity * g.element_size << "\n";
+  }
+  return os;
+}
+
+} // namespace hypervector_instrumentation
+
+#endif // HYPERVECTOR_INSTRUMENTATION_H
@@ -0,0 +1,125 @@
+#ifndef HYPERVECTOR_INTEROP_H
+#define HYPERVECTOR_INTEROP_H
+
+#include "hypervector_detail.h"
+#include "hypervector_ref.h"
+#include "hypervector_view.h"
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <version>
+
+#if __has_include(<mdspan>)
+# include <mdspan>
+#endif
+
+namespace hypervector_detail {
+
+// matches views and everything derived from them, i.e. containers and refs
+template<typename T, size_t Dims, bool IsConst>
+std::integral_constant<size_t, Dims> view_dims_(const hypervector_view<T, Dims, IsConst>&);
+
+template<typename V>
+concept view_like = requires(const V& v) {
+  view_dims_(v);
+};
+
+template<typename V>
+constexpr size_t view_dims = decltype(view_dims_(std::declval<const V&>()))::value;
+
+
+template<typename View, size_t ...Dim>
+std::array<size_type, sizeof...(Dim)> extents_of_(const View& hvec, std::index_sequence<Dim...>) noexcept {
+  return {hvec.template sizeOf<Dim>()...};
+}
+
+template<typename View, size_t ...Dim>
+std::array<size_type, sizeof...(Dim)> strides_of_(const View& hvec, std::index_sequence<Dim...>) noexcept {
+  return {hvec.template offsetOf<Dim>()...};
+}
+
+} // namespace hypervector_detail
+
+
+/// zero-copy std::span on the contiguous storage of a view, container or ref;
+/// elements are const if the view is
+template<typename View>
+  requires hypervector_detail::view_like<std::remove_cvref_t<View>>
+auto to_span(View&& hvec) noexcept {
+  return std::span(hvec.data(), hvec.size());
+}
+
+
+/// non-owning ref on (a part of) given span in given shape
+template<typename T, size_t Extent, typename ...Sizes>
+hypervector_ref<std::remove_const_t<T>, sizeof...(Sizes), std::is_const_v<T>>
+to_hypervector_ref(std::span<T, Extent> span, Sizes... sizes) {
+  static_assert(sizeof...(Sizes) > 0, "to_hypervector_ref");
+  if ((static_cast<hypervector_detail::size_type>(sizes) * ...) > span.size())
+    throw std::invalid_argument("to_hypervector_ref: span too small for shape");
+  return {span.data(), static_cast<hypervector_detail::size_type>(sizes)...};
+}
+
+
+#if defined(__cpp_lib_mdspan)
+
+/// zero-copy std::mdspan with layout_right on a view, container or ref
+template<typename View>
+  requires hypervector_detail::view_like<std::remove_cvref_t<View>>
+auto to_mdspan(View&& hvec) noexcept {
+  constexpr auto Dims = hypervector_detail::view_dims<std::remove_cvref_t<View>>;
+  using element_type = std::remove_pointer_t<decltype(hvec.data())>;
+  using extents_type = std::dextents<hypervector_detail::size_type, Dims>;
+
+  return std::mdspan<element_type, extents_type, std::layout_right>(
+    hvec.data(),
+    hypervector_detail::extents_of_(hvec, std::make_index_sequence<Dims>()));
+}
+
+
+/// zero-copy std::mdspan with layout_stride on a view, container or ref;
+/// strides are the views' offsetOf<Dim>()
+template<typename View>
+  requires hypervector_detail::view_like<std::remove_cvref_t<View>>
+auto to_mdspan_strided(View&& hvec) noexcept {
+  constexpr auto Dims = hypervector_detail::view_dims<std::remove_cvref_t<View>>;
+  using element_type = std::remove_pointer_t<decltype(hvec.data())>;
+  using extents_type = std::dextents<hypervector_detail::size_type, Dims>;
+
+  auto mapping = std::layout_stride::mapping<extents_type>(
+    extents_type(hypervector_detail::extents_of_(hvec, std::make_index_sequence<Dims>())),
+    hypervector_detail::strides_of_(hvec, std::make_index_sequence<Dims>()));
+  return std::mdspan<element_type, extents_type, std::layout_stride>(hvec.data(), mapping);
+}
+
+
+/// non-owning ref on the data of given mdspan which needs to be row-major contiguous
+template<typename T, typename Extents, typename Layout>
+hypervector_ref<std::remove_const_t<T>, Extents::rank(), std::is_const_v<T>>
+to_hypervector_ref(const std::mdspan<T, Extents, Layout>& md) {
+  constexpr auto Dims = Extents::rank();
+  static_assert(Dims > 0, "to_hypervector_ref");
+
+  if constexpr (!std::is_same_v<Layout, std::layout_right>) {
+    typename Extents::index_type stride = 1;
+    for (auto dim = Dims; dim-- > 0;) {
+      if (md.extent(dim) > 1 && md.stride(dim) != stride)
+        throw std::invalid_argument("to_hypervector_ref: mdspan is not row-major contiguous");
+      stride *= md.extent(dim);
+    }
+  }
+
+  return [&]<size_t ...Dim>(std::index_sequence<Dim...>) {
+    return hypervector_ref<std::remove_const_t<T>, Dims, std::is_const_v<T>>(
+      md.data_handle(),
+      static_cast<hypervector_detail::size_type>(md.extent(Dim))...);
+  }(std::make_index_sequence<Dims>());
+}
+
+#endif // __cpp_lib_mdspan
+
+#endif // HYPERVECTOR_INTEROP_H
@@ -0,0 +1,380 @@
+#ifndef HYPERVECTOR_LINALG_H
+#define HYPERVECTOR_LINALG_H
+
+#include "hypervector_view.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// dependency-free dense linear algebra on 2D hypervector views (row-major,
+// leading dimension ld()); uses std::thread, i.e. link e.g. Threads::Threads
+namespace hypervector_linalg {
+
+using size_type = hypervector_detail::size_type;
+
+namespace detail {
+
+// register tile of the micro-kernel and cache blocking of the packed operands
+constexpr size_type MR = 4; ///< rows of C per micro-kernel
+constexpr size_type NR = 8; ///< columns of C per micro-kernel
+constexpr size_type MC = 128; ///< rows of A packed per block (L2)
+constexpr size_type KC = 256; ///< depth of A and B packed per block (L1 for a micro-panel)
+constexpr size_type NC = 2048; ///< columns of B packed per block (L3)
+
+// below this number of multiply-adds spawning threads does not pay off
+constexpr size_type parallel_threshold = size_type(1) << 21;
+
+
+inline unsigned thread_count(unsigned threads, size_type work, size_type max_parallel) {
+  if (threads == 0)
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+  if (work < parallel_threshold)
+    threads = 1;
+  return static_cast<unsigned>(std::min<size_type>(threads, std::max<size_type>(max_parallel, 1)));
+}
+
+
+// call f(thread, first, last) for contiguous chunks of [0, count) in parallel,
+// thread < threads; rethrows the first exception of any thread on the calling one
+template<typename F>
+void parallel_for(unsigned threads, size_type count, size_type granularity, F&& f) {
+  auto chunks = (count + granularity - 1) / granularity;
+  if (threads <= 1 || chunks <= 1) {
+    f(0u, size_type(0), count);
+    return;
+  }
+
+  threads = static_cast<unsigned>(std::min<size_type>(threads, chunks));
+  std::vector<std::exception_ptr> errors(threads);
+  {
+    std::vector<std::jthread> workers; // joined on every path, also if spawning throws
+    workers.reserve(threads - 1);
+    size_type first = 0;
+    for (unsigned t = 0; t < threads; ++t) {
+      // distribute whole chunks evenly, remainder to the leading threads
+      auto n = (chunks / threads + (t < chunks % threads ? 1 : 0)) * granularity;
+      auto last = std::min(first + n, count);
+      auto run = [&f, &errors, t, first, last]() noexcept {
+        try {
+          f(t, first, last);
+        } catch (...) {
+          errors[t] = std::current_exception();
+        }
+      };
+      if (t + 1 == threads)
+        run(); // the calling thread takes the last chunk
+      else
+        workers.emplace_back(run);
+      first = last;
+    }
+  }
+  for (auto&& error : errors)
+    if (error)
+      std::rethrow_exception(error);
+}
+
+
+// copy a kc x nc block of B into NR-wide column panels, zero-padded
+template<typename T>
+void pack_b(size_type kc, size_type nc, const T* b, size_type ldb, T* packed) {
+  for (size_type j = 0; j < nc; j += NR) {
+    auto nr = std::min(NR, nc - j);
+    for (size_type p = 0; p < kc; ++p) {
+      const T* src = b + p * ldb + j;
+      size_type jj = 0;
+      for (; jj < nr; ++jj)
+        *packed++ = src[jj];
+      for (; jj < NR; ++jj)
+        *packed++ = T();
+    }
+  }
+}
+
+
+// copy an mc x kc block of A scaled by alpha into MR-high row panels, zero-padded
+template<typename T>
+void pack_a(size_type mc, size_type kc, T alpha, const T* a, size_type lda, T* packed) {
+  for (size_type i = 0; i < mc; i += MR) {
+    auto mr = std::min(MR, mc - i);
+    for (size_type p = 0; p < kc; ++p) {
+      size_type ii = 0;
+      for (; ii < mr; ++ii)
+        *packed++ = alpha * a[(i + ii) * lda + p];
+      for (; ii < MR; ++ii)
+        *packed++ = T();
+    }
+  }
+}
+
+
+// C[mr x nr] += A_panel * B_panel with the whole tile held in registers
+template<typename T>
+void micro_kernel(size_type kc, const T* a, const T* b, T* c, size_type ldc, size_type mr, size_type nr) {
+  // rows spelled out so that the accumulators stay in (vector) registers
+  // without relying on the optimizer to unroll and scalarize a 2D array
+  static_assert(MR == 4, "micro_kernel is unrolled for MR == 4");
+  T acc[MR][NR] = {};
+  for (size_type p = 0; p < kc; ++p, a += MR, b += NR) {
+    const T a0 = a[0], a1 = a[1], a2 = a[2], a3 = a[3];
+    for (size_type j = 0; j < NR; ++j) {
+      const T bj = b[j];
+      acc[0][j] += a0 * bj;
+      acc[1][j] += a1 * bj;
+      acc[2][j] += a2 * bj;
+      acc[3][j] += a3 * bj;
+    }
+  }
+
+  if (mr == MR && nr == NR) {
+    for (size_type i = 0; i < MR; ++i)
+      for (size_type j = 0; j < NR; ++j)
+        c[i * ldc + j] += acc[i][j];
+  } else {
+    for (size_type i = 0; i < mr; ++i)
+      for (size_type j = 0; j < nr; ++j)
+        c[i * ldc + j] += acc[i][j];
+  }
+}
+
+
+// C[m x n] = beta * C
+template<typename T>
+void scale(size_type m, size_type n, T beta, T* c, size_type ldc) {
+  if (beta == T(1))
+    return;
+  for (size_type i = 0; i < m; ++i) {
+    T* row = c + i * ldc;
+    if (beta == T())
+      std::fill_n(row, n, T()); // don't propagate NaN/Inf from uninitialized C
+    else
+      for (size_type j = 0; j < n; ++j)
+        row[j] *= beta;
+  }
+}
+
+
+inline size_type round_up(size_type v, size_type r) {
+  return (v + r - 1) / r * r;
+}
+
+
+// elements of packed B and packed A needed by gemm_serial for at most m x n x k
+inline size_type workspace_size(size_type m, size_type n, size_type k) {
+  return std::min(KC, k) * round_up(std::min(NC, n), NR) + round_up(std::min(MC, m), MR) * std::min(KC, k);
+}
+
+
+// C[m x n] += alpha * A[m x k] * B[k x n], single-threaded, all row-major;
+// packs into workspace of workspace_size(m, n, k) elements
+template<typename T>
+void gemm_serial(
+    size_type m, size_type n, size_type k,
+    T alpha,
+    const T* a, size_type lda,
+    const T* b, size_type ldb,
+    T* c, size_type ldc,
+    T* workspace) {
+  if (m == 0 || n == 0 || k == 0 || alpha == T())
+    return;
+
+  T* packed_b = workspace;
+  T* packed_a = workspace + std::min(KC, k) * round_up(std::min(NC, n), NR);
+
+  for (size_type jc = 0; jc < n; jc += NC) {
+    auto nc = std::min(NC, n - jc);
+    for (size_type pc = 0; pc < k; pc += KC) {
+      auto kc = std::min(KC, k - pc);
+      pack_b(kc, nc, b + pc * ldb + jc, ldb, packed_b);
+
+      for (size_type ic = 0; ic < m; ic += MC) {
+        auto mc = std::min(MC, m - ic);
+        pack_a(mc, kc, alpha, a + ic * lda + pc, lda, packed_a);
+
+        for (size_type jr = 0; jr < nc; jr += NR) {
+          auto nr = std::min(NR, nc - jr);
+          for (size_type ir = 0; ir < mc; ir += MR) {
+            auto mr = std::min(MR, mc - ir);
+            micro_kernel(
+              kc,
+              packed_a + ir * kc,
+              packed_b + jr * kc,
+              c + (ic + ir) * ldc + jc + jr, ldc,
+              mr, nr);
+          }
+        }
+      }
+    }
+  }
+}
+
+
+// C[m x n] = alpha * A[m x k] * B[k x n] + beta * C, rows of C split among threads
+template<typename T>
+void gemm(
+    unsigned threads,
+    size_type m, size_type n, size_type k,
+    T alpha,
+    const T* a, size_type lda,
+    const T* b, size_type ldb,
+    T beta,
+    T* c, size_type ldc) {
+  threads = thread_count(threads, m * n * k, (m + MR - 1) / MR);
+  const auto per_thread = workspace_size(m, n, k);
+  std::vector<T> workspace(threads * per_thread); // allocated before any thread starts
+  parallel_for(threads, m, MR, [&](unsigned t, size_type first, size_type last) {
+    scale(last - first, n, beta, c + first * ldc, ldc);
+    gemm_serial(last - first, n, k, alpha, a + first * lda, lda, b, ldb, c + first * ldc, ldc, workspace.data() + t * per_thread);
+  });
+}
+
+
+// y[m] = alpha * A[m x n] * x[n] + beta * y
+template<typename T>
+void gemv_serial(
+    size_type m, size_type n,
+    T alpha,
+    const T* a, size_type lda,
+    const T* x,
+    T beta,
+    T* y) {
+  // four rows at a time to reuse each load of x
+  size_type i = 0;
+  for (; i + 4 <= m; i += 4) {
+    const T* a0 = a + i * lda;
+    const T* a1 = a0 + lda;
+    const T* a2 = a1 + lda;
+    const T* a3 = a2 + lda;
+    T s0 = T(), s1 = T(), s2 = T(), s3 = T();
+    for (size_type j = 0; j < n; ++j) {
+      s0 += a0[j] * x[j];
+      s1 += a1[j] * x[j];
+      s2 += a2[j] * x[j];
+      s3 += a3[j] * x[j];
+    }
+    y[i + 0] = alpha * s0 + (beta == T() ? T() : beta * y[i + 0]);
+    y[i + 1] = alpha * s1 + (beta == T() ? T() : beta * y[i + 1]);
+    y[i + 2] = alpha * s2 + (beta == T() ? T() : beta * y[i + 2]);
+    y[i + 3] = alpha * s3 + (beta == T() ? T() : beta * y[i + 3]);
+  }
+  for (; i < m; ++i) {
+    const T* ai = a + i * lda;
+    T s = T();
+    for (size_type j = 0; j < n; ++j)
+      s += ai[j] * x[j];
+    y[i] = alpha * s + (beta == T() ? T() : beta * y[i]);
+  }
+}
+
+} // namespace detail
+
+
+/// C = alpha * A * B + beta * C
+///
+/// cache-blocked and register-tiled; rows of C are distributed over the given
+/// number of threads (0: hardware concurrency) for large enough problems
+template<typename T, bool IsConstA, bool IsConstB>
+void gemm(
+    std::type_identity_t<T> alpha,
+    const hypervector_view<T, 2, IsConstA>& a,
+    const hypervector_view<T, 2, IsConstB>& b,
+    std::type_identity_t<T> beta,
+    hypervector_view<T, 2, false> c,
+    unsigned threads = 0) {
+  auto m = a.template sizeOf<0>();
+  auto k = a.template sizeOf<1>();
+  auto n = b.template sizeOf<1>();
+  if (b.template sizeOf<0>() != k || c.template sizeOf<0>() != m || c.template sizeOf<1>() != n)
+    throw std::invalid_argument("hypervector_linalg::gemm: dimension mismatch");
+
+  detail::gemm(threads, m, n, k, alpha, a.data(), a.ld(), b.data(), b.ld(), beta, c.data(), c.ld());
+}
+
+
+/// C = A * B
+template<typename T, bool IsConstA, bool IsConstB>
+void gemm(
+    const hypervector_view<T, 2, IsConstA>& a,
+    const hypervector_view<T, 2, IsConstB>& b,
+    hypervector_view<T, 2, false> c,
+    unsigned threads = 0) {
+  gemm(T(1), a, b, T(), c, threads);
+}
+
+
+/// C[i] = alpha * A[i] * B[i] + beta * C[i] for all i of the outer dimension
+///
+/// matrices of the batch are distributed over the given number of threads
+template<typename T, bool IsConstA, bool IsConstB>
+void gemm_batched(
+    std::type_identity_t<T> alpha,
+    const hypervector_view<T, 3, IsConstA>& a,
+    const hypervector_view<T, 3, IsConstB>& b,
+    std::type_identity_t<T> beta,
+    hypervector_view<T, 3, false> c,
+    unsigned threads = 0) {
+  auto batch = a.template sizeOf<0>();
+  if (b.template sizeOf<0>() != batch || c.template sizeOf<0>() != batch)
+    throw std::invalid_argument("hypervector_linalg::gemm_batched: batch size mismatch");
+  if (batch == 0)
+    return;
+
+  auto m = a.template sizeOf<1>();
+  auto k = a.template sizeOf<2>();
+  auto n = b.template sizeOf<2>();
+  if (b.template sizeOf<1>() != k || c.template sizeOf<1>() != m || c.template sizeOf<2>() != n)
+    throw std::invalid_argument("hypervector_linalg::gemm_batched: dimension mismatch");
+
+  threads = detail::thread_count(threads, batch * m * n * k, batch);
+  const auto per_thread = detail::workspace_size(m, n, k);
+  std::vector<T> workspace(threads * per_thread); // allocated before any thread starts
+  detail::parallel_for(threads, batch, 1, [&](unsigned t, size_type first, size_type last) {
+    for (auto i = first; i < last; ++i) {
+      auto ai = a[i];
+      auto bi = b[i];
+      auto ci = c[i];
+      detail::scale(m, n, beta, ci.data(), ci.ld());
+      detail::gemm_serial(m, n, k, alpha, ai.data(), ai.ld(), bi.data(), bi.ld(), ci.data(), ci.ld(), workspace.data() + t * per_thread);
+    }
+  });
+}
+
+
+/// y = alpha * A * x + beta * y
+template<typename T, bool IsConstA, bool IsConstX>
+void gemv(
+    std::type_identity_t<T> alpha,
+    const hypervector_view<T, 2, IsConstA>& a,
+    const hypervector_view<T, 1, IsConstX>& x,
+    std::type_identity_t<T> beta,
+    hypervector_view<T, 1, false> y,
+    unsigned threads = 0) {
+  auto m = a.template sizeOf<0>();
+  auto n = a.template sizeOf<1>();
+  if (x.size() != n || y.size() != m)
+    throw std::invalid_argument("hypervector_linalg::gemv: dimension mismatch");
+
+  threads = detail::thread_count(threads, m * n, m / 4);
+  detail::parallel_for(threads, m, 4, [&](unsigned, size_type first, size_type last) {
+    detail::gemv_serial(last - first, n, alpha, a.data() + first * a.ld(), a.ld(), x.data(), beta, y.data() + first);
+  });
+}
+
+
+/// y = A * x
+template<typename T, bool IsConstA, bool IsConstX>
+void gemv(
+    const hypervector_view<T, 2, IsConstA>& a,
+    const hypervector_view<T, 1, IsConstX>& x,
+    hypervector_view<T, 1, false> y,
+    unsigned threads = 0) {
+  gemv(T(1), a, x, T(), y, threads);
+}
+
+} // namespace hypervector_linalg
+
+#endif // HYPERVECTOR_LINALG_H
@@ -0,0 +1,79 @@
+#ifndef HYPERVECTOR_REF_H
+#define HYPERVECTOR_REF_H
+
+#include "hypervector_detail.h"
+#include "hypervector_view.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+
+namespace hypervector_detail {
+
+// holds the shape before the view base that points to it is constructed
+template<size_t Dims>
+struct shape_storage
+{
+  dimension shape_[Dims];
+};
+
+} // namespace hypervector_detail
+
+/// non-owning view on an external contiguous (row-major) buffer;
+/// unlike a plain view it carries its own shape, i.e. needs no container
+template<typename T, size_t Dims, bool IsConst = false>
+struct hypervector_ref
+  : private hypervector_detail::shape_storage<Dims>
+  , public hypervector_view<T, Dims, IsConst>
+{
+  using view = hypervector_view<T, Dims, IsConst>;
+  using size_type = typename view::size_type;
+  using value_storage = typename view::value_storage;
+
+private:
+  using storage = hypervector_detail::shape_storage<Dims>;
+
+public:
+  // hypervector_ref(pointer data, size_type count...)
+  /// wrap given buffer of at least count0 * count1 * ... elements
+  template<typename ...Sizes>
+  hypervector_ref(
+      value_storage data,
+      typename std::enable_if<sizeof...(Sizes) == Dims - 1, size_type>::type size0,
+      Sizes&&... sizes) noexcept
+    : storage()
+    , view(storage::shape_, data) {
+    const size_type extents[Dims] = {size0, static_cast<size_type>(sizes)...};
+    size_type offset = 1;
+    for (size_t dim = Dims; dim-- > 0;) {
+      storage::shape_[dim].size = extents[dim];
+      storage::shape_[dim].offset = offset;
+      offset *= extents[dim];
+    }
+  }
+
+
+  /// wrap the storage of given view (or container) with a shape of its own
+  template<bool IsConstO,
+           typename = typename std::enable_if<IsConst || !IsConstO>::type>
+  hypervector_ref(const hypervector_view<T, Dims, IsConstO>& other) noexcept
+    : storage()
+    , view(storage::shape_, other.vals_) {
+    std::copy_n(other.dims_, Dims, storage::shape_);
+  }
+
+
+  hypervector_ref(const hypervector_ref& other) noexcept
+    : storage(other)
+    , view(storage::shape_, other.vals_) {
+  }
+
+
+  hypervector_ref& operator=(const hypervector_ref& other) noexcept {
+    std::copy_n(other.shape_, Dims, storage::shape_);
+    view::vals_ = other.vals_;
+    return *this;
+  }
+};
+
+#endif // HYPERVECTOR_REF_H
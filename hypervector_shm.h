@@ -0,0 +1,393 @@
+#ifndef HYPERVECTOR_SHM_H
+#define HYPERVECTOR_SHM_H
+
+#include "hypervector_detail.h"
+#include "hypervector_ref.h"
+#include "hypervector_view.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace hypervector_detail {
+
+/// header at the start of a shared memory segment;
+/// holds offsets instead of pointers so that the segment maps at any address
+struct shm_header
+{
+  static constexpr std::uint64_t magic_value = 0x6876656374736d31; // "hvectsm1"
+
+  std::atomic<std::uint64_t> magic; ///< written last by the creator
+  std::atomic<std::uint64_t> sequence; ///< seqlock; odd while the writer modifies
+  std::uint64_t dims; ///< number of dimensions
+  std::uint64_t element_size; ///< sizeof element type
+  std::uint64_t capacity; ///< number of elements the segment holds
+  std::uint64_t dims_offset; ///< offset of dimension[dims] from segment start
+  std::uint64_t vals_offset; ///< offset of the element data from segment start
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+  "hypervector_shm requires address-free atomics");
+
+
+/// base of hypervector_shm; the writer is the segment's only modifier and
+/// may access it as a view, readers must go through read()
+template<typename T, size_t Dims, bool IsConst>
+struct shm_view_base : public hypervector_view<T, Dims, IsConst>
+{
+  using hypervector_view<T, Dims, IsConst>::hypervector_view;
+};
+
+template<typename T, size_t Dims>
+struct shm_view_base<T, Dims, true> : protected hypervector_view<T, Dims, true>
+{
+  using hypervector_view<T, Dims, true>::hypervector_view;
+};
+
+} // namespace hypervector_detail
+
+/// hypervector with shape and data in a POSIX shared memory segment
+///
+/// one process creates the named segment with a fixed capacity and reshapes
+/// and writes it; any number of processes attach (read-only if IsConst) and
+/// share the data without copies. The single writer brackets modifications
+/// with a seqlock so that readers can detect concurrent reshapes via read()
+/// or version(); read-only instances expose the data via read() only
+template<typename T, size_t Dims, bool IsConst = false>
+struct hypervector_shm : public hypervector_detail::shm_view_base<T, Dims, IsConst>
+{
+  static_assert(std::is_trivially_copyable<T>::value,
+    "hypervector_shm requires trivially copyable elements");
+
+  using view = hypervector_view<T, Dims, IsConst>;
+  using const_view = hypervector_view<T, Dims, true>;
+  using const_ref = hypervector_ref<T, Dims, true>;
+  using size_type = typename view::size_type;
+
+private:
+  using base = hypervector_detail::shm_view_base<T, Dims, IsConst>;
+  using header_storage = typename std::conditional<IsConst,
+    const hypervector_detail::shm_header*,
+    hypervector_detail::shm_header*>::type;
+
+  header_storage header_; ///< start of the mapped segment
+  size_t mapping_size_; ///< size of the mapped segment
+
+public:
+  /// create a new named segment (e.g. "/grid") able to hold capacity elements;
+  /// the grid is empty until assign() or resize()
+  template<bool IsConst_ = IsConst,
+           typename = typename std::enable_if<!IsConst_>::type>
+  static hypervector_shm create(
+      const char* name,
+      size_type capacity,
+      mode_t mode = 0600) {
+    auto vals_offset = vals_offset_();
+    auto mapping_size = vals_offset + std::max<size_t>(capacity * sizeof(T), 1);
+
+    int fd = ::shm_open(name, O_CREAT | O_EXCL | O_RDWR, mode);
+    if (fd < 0)
+      throw std::system_error(errno, std::generic_category(), "hypervector_shm::create: shm_open");
+    if (::ftruncate(fd, static_cast<off_t>(mapping_size)) != 0) {
+      auto err = errno;
+      ::close(fd);
+      ::shm_unlink(name);
+      throw std::system_error(err, std::generic_category(), "hypervector_shm::create: ftruncate");
+    }
+    void* addr = ::mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    auto err = errno;
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+      ::shm_unlink(name);
+      throw std::system_error(err, std::generic_category(), "hypervector_shm::create: mmap");
+    }
+
+    auto header = ::new (addr) hypervector_detail::shm_header{};
+    header->sequence.store(0, std::memory_order_relaxed);
+    header->dims = Dims;
+    header->element_size = sizeof(T);
+    header->capacity = capacity;
+    header->dims_offset = sizeof(hypervector_detail::shm_header);
+    header->vals_offset = vals_offset;
+    ::new (static_cast<char*>(addr) + header->dims_offset) hypervector_detail::dimension[Dims]{};
+    header->magic.store(hypervector_detail::shm_header::magic_value, std::memory_order_release);
+
+    return hypervector_shm(header, mapping_size);
+  }
+
+
+  /// map an existing segment created with matching element type and dimensions
+  static hypervector_shm attach(const char* name) {
+    int fd = ::shm_open(name, IsConst ? O_RDONLY : O_RDWR, 0);
+    if (fd < 0)
+      throw std::system_error(errno, std::generic_category(), "hypervector_shm::attach: shm_open");
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      auto err = errno;
+      ::close(fd);
+      throw std::system_error(err, std::generic_category(), "hypervector_shm::attach: fstat");
+    }
+    auto mapping_size = static_cast<size_t>(st.st_size);
+    if (mapping_size < sizeof(hypervector_detail::shm_header)) {
+      ::close(fd);
+      throw std::runtime_error("hypervector_shm::attach: segment too small");
+    }
+    void* addr = ::mmap(nullptr, mapping_size, IsConst ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    auto err = errno;
+    ::close(fd);
+    if (addr == MAP_FAILED)
+      throw std::system_error(err, std::generic_category(), "hypervector_shm::attach: mmap");
+
+    auto header = static_cast<header_storage>(addr);
+    const char* what = nullptr;
+    if (header->magic.load(std::memory_order_acquire) != hypervector_detail::shm_header::magic_value)
+      what = "hypervector_shm::attach: segment not initialized";
+    else if (header->dims != Dims || header->element_size != sizeof(T))
+      what = "hypervector_shm::attach: element type or dimensions mismatch";
+    else if (header->vals_offset + header->capacity * sizeof(T) > mapping_size)
+      what = "hypervector_shm::attach: segment truncated";
+    if (what) {
+      ::munmap(addr, mapping_size);
+      throw std::runtime_error(what);
+    }
+
+    return hypervector_shm(header, mapping_size);
+  }
+
+
+  /// remove the name of a segment; mappings stay valid until unmapped
+  static void remove(const char* name) {
+    if (::shm_unlink(name) != 0)
+      throw std::system_error(errno, std::generic_category(), "hypervector_shm::remove: shm_unlink");
+  }
+
+
+  hypervector_shm(const hypervector_shm&) = delete;
+  hypervector_shm& operator=(const hypervector_shm&) = delete;
+
+
+  hypervector_shm(hypervector_shm&& other) noexcept
+    : base(other.dims_, other.vals_)
+    , header_(std::exchange(other.header_, nullptr))
+    , mapping_size_(std::exchange(other.mapping_size_, 0)) {
+    other.dims_ = nullptr;
+    other.vals_ = nullptr;
+  }
+
+
+  hypervector_shm& operator=(hypervector_shm&& other) noexcept {
+    using std::swap;
+    swap(view::dims_, other.dims_);
+    swap(view::vals_, other.vals_);
+    swap(header_, other.header_);
+    swap(mapping_size_, other.mapping_size_);
+    return *this;
+  }
+
+
+  ~hypervector_shm() {
+    if (header_)
+      ::munmap(const_cast<hypervector_detail::shm_header*>(header_), mapping_size_);
+  }
+
+
+  // void resize(size_type count..., const T& value)
+  /// reshape within capacity; newly created elements will be set to given value
+  template<typename ...Sizes>
+  typename std::enable_if<!IsConst && sizeof...(Sizes) == Dims, void>::type
+  resize(
+      size_type size0,
+      Sizes&&... sizes) {
+    size_type extents[Dims];
+    resize_(false, extents, size0, std::forward<Sizes>(sizes)...);
+  }
+
+
+  // void resize(size_type count...)
+  /// reshape within capacity; newly created elements will be value-initialized
+  template<typename ...Sizes>
+  typename std::enable_if<!IsConst && sizeof...(Sizes) == Dims - 1, void>::type
+  resize(
+      size_type size0,
+      Sizes&&... sizes) {
+    size_type extents[Dims];
+    resize_(false, extents, size0, std::forward<Sizes>(sizes)..., T());
+  }
+
+
+  // void assign(size_type count..., const T& value)
+  /// reshape within capacity and set all elements to given value
+  template<typename ...Sizes>
+  typename std::enable_if<!IsConst && sizeof...(Sizes) == Dims, void>::type
+  assign(
+      size_type size0,
+      Sizes&&... sizes) {
+    size_type extents[Dims];
+    resize_(true, extents, size0, std::forward<Sizes>(sizes)...);
+  }
+
+
+  /// modify shape or data as f(view&) visible to readers as one update
+  template<typename F, bool IsConst_ = IsConst,
+           typename = typename std::enable_if<!IsConst_>::type>
+  void write(F&& f) {
+    auto seq = header_->sequence.load(std::memory_order_relaxed);
+    header_->sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    struct guard
+    {
+      hypervector_detail::shm_header* header;
+      std::uint64_t seq;
+      ~guard() { header->sequence.store(seq + 2, std::memory_order_release); }
+    } g{header_, seq};
+
+    f(static_cast<view&>(*this));
+  }
+
+
+  /// call f(const_ref) until it ran without a concurrent write and return
+  /// its result; f gets a copy of the shape that always lies within capacity,
+  /// but may see torn data (and must not act on it) if it is retried
+  template<typename F>
+  auto read(F&& f) const {
+    for (;;) {
+      auto seq = header_->sequence.load(std::memory_order_acquire);
+      if (seq & 1) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      auto shape = shape_(std::make_index_sequence<Dims>());
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (!shape || header_->sequence.load(std::memory_order_relaxed) != seq)
+        continue;
+
+      if constexpr (std::is_void<decltype(f(std::declval<const const_ref&>()))>::value) {
+        f(static_cast<const const_ref&>(*shape));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header_->sequence.load(std::memory_order_relaxed) == seq)
+          return;
+      } else {
+        auto result = f(static_cast<const const_ref&>(*shape));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header_->sequence.load(std::memory_order_relaxed) == seq)
+          return result;
+      }
+    }
+  }
+
+
+  /// seqlock counter, i.e. twice the number of completed writes and odd while
+  /// a write is in progress; data read between two equal, even versions is consistent
+  std::uint64_t version() const noexcept {
+    return header_->sequence.load(std::memory_order_acquire);
+  }
+
+
+  /// whether given version() was taken while a write was in progress
+  static constexpr bool writing(std::uint64_t version) noexcept {
+    return (version & 1) != 0;
+  }
+
+
+  /// number of elements the segment holds
+  size_type capacity() const noexcept {
+    return static_cast<size_type>(header_->capacity);
+  }
+
+private:
+  hypervector_shm(header_storage header, size_t mapping_size) noexcept
+    : base(
+        reinterpret_cast<typename view::dimension_storage>(base_(header) + header->dims_offset),
+        reinterpret_cast<typename view::value_storage>(base_(header) + header->vals_offset))
+    , header_(header)
+    , mapping_size_(mapping_size) {
+  }
+
+
+  // local copy of the (possibly concurrently modified) shape with offsets
+  // recomputed from the sizes; none if the sizes exceed capacity
+  template<size_t ...Dim>
+  std::optional<const_ref> shape_(std::index_sequence<Dim...>) const noexcept {
+    const size_type sizes[Dims] = {view::dims_[Dim].size...};
+    size_type total = 1;
+    for (auto size : sizes) {
+      if (size != 0 && total > capacity() / size)
+        total = capacity() + 1; // also guards the product against overflow
+      else
+        total *= size;
+    }
+    if (total > capacity())
+      return std::nullopt;
+    return const_ref(view::vals_, sizes[Dim]...);
+  }
+
+
+  static char* base_(header_storage header) noexcept {
+    // constness of the mapping is restored by the view's storage types
+    return const_cast<char*>(reinterpret_cast<const char*>(header));
+  }
+
+
+  static constexpr size_t vals_offset_() noexcept {
+    constexpr size_t alignment = std::max<size_t>(alignof(T), 64); // cache line
+    constexpr size_t end = sizeof(hypervector_detail::shm_header) + Dims * sizeof(hypervector_detail::dimension);
+    return (end + alignment - 1) / alignment * alignment;
+  }
+
+
+  template<typename ...Sizes>
+  typename std::enable_if<sizeof...(Sizes) <= Dims, void>::type
+  resize_(
+      bool overwrite,
+      size_type* extents,
+      size_type size0,
+      Sizes&&... sizes) {
+    constexpr auto Dim = Dims - sizeof...(Sizes);
+    extents[Dim] = size0;
+    resize_(overwrite, extents, std::forward<Sizes>(sizes)...);
+  }
+
+  void resize_(
+      bool overwrite,
+      size_type* extents,
+      const T& val) {
+    size_type new_size = 1;
+    for (size_t dim = 0; dim < Dims; ++dim)
+      new_size *= extents[dim];
+    if (new_size > capacity())
+      throw std::length_error("hypervector_shm::resize: exceeds capacity");
+
+    write([&](view&) {
+      auto old_size = view::size();
+      if (overwrite)
+        std::fill_n(view::vals_, new_size, val);
+      else if (new_size > old_size)
+        std::fill_n(view::vals_ + old_size, new_size - old_size, val);
+
+      size_type offset = 1;
+      for (size_t dim = Dims; dim-- > 0;) {
+        view::dims_[dim].size = extents[dim];
+        view::dims_[dim].offset = offset;
+        offset *= extents[dim];
+      }
+    });
+  }
+};
+
+#endif // HYPERVECTOR_SHM_H
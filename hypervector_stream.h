@@ -0,0 +1,307 @@
+#ifndef HYPERVECTOR_STREAM_H
+#define HYPERVECTOR_STREAM_H
+
+#include "hypervector_detail.h"
+#include "hypervector_ref.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// sequential reader of the slices along dimension 0 of a grid stored as raw
+/// row-major elements in a file, e.g. for out-of-core processing
+///
+/// a background thread reads ahead up to prefetch slices into a pool of
+/// reused buffers; it blocks while all buffers are in flight (back-pressure)
+/// so that the computation on slice k overlaps the reads of slices
+/// k+1..k+prefetch. Slices are handed out one by one via next() or the
+/// single-pass range interface and return their buffer when destroyed
+template<typename T, size_t Dims>
+class hypervector_slice_reader
+{
+  static_assert(Dims > 1, "hypervector_slice_reader");
+  static_assert(std::is_trivially_copyable<T>::value,
+    "hypervector_slice_reader requires trivially copyable elements");
+
+public:
+  using size_type = hypervector_detail::size_type;
+
+  /// slice k of the grid in a pooled buffer
+  class slice : public hypervector_ref<T, Dims - 1>
+  {
+    using ref = hypervector_ref<T, Dims - 1>;
+
+    hypervector_slice_reader* reader_;
+    size_type index_;
+    size_type buffer_;
+
+  public:
+    slice(hypervector_slice_reader* reader, size_type index, size_type buffer)
+      : ref(reader->ref_(buffer, std::make_index_sequence<Dims - 1>()))
+      , reader_(reader)
+      , index_(index)
+      , buffer_(buffer) {
+    }
+
+    slice(slice&& other) noexcept
+      : ref(other)
+      , reader_(std::exchange(other.reader_, nullptr))
+      , index_(other.index_)
+      , buffer_(other.buffer_) {
+    }
+
+    slice& operator=(slice&& other) noexcept {
+      if (this != &other) {
+        if (reader_)
+          reader_->release_(buffer_); // hand back the buffer held so far
+        ref::operator=(other);
+        reader_ = std::exchange(other.reader_, nullptr);
+        index_ = other.index_;
+        buffer_ = other.buffer_;
+      }
+      return *this;
+    }
+
+    ~slice() {
+      if (reader_)
+        reader_->release_(buffer_);
+    }
+
+    /// position of this slice along dimension 0
+    size_type index() const noexcept {
+      return index_;
+    }
+  };
+
+
+  /// move-only input iterator; compares equal to std::default_sentinel when done
+  class iterator
+  {
+    hypervector_slice_reader* reader_;
+    mutable std::optional<slice> current_; ///< the slice is the reader's buffer, not iterator state
+
+  public:
+    using value_type = slice;
+    using difference_type = std::ptrdiff_t;
+    using iterator_concept = std::input_iterator_tag;
+
+    explicit iterator(hypervector_slice_reader* reader = nullptr)
+      : reader_(reader) {
+      advance_();
+    }
+
+    iterator(iterator&&) noexcept = default;
+    iterator& operator=(iterator&&) noexcept = default;
+
+    slice& operator*() const noexcept {
+      return *current_;
+    }
+
+    slice* operator->() const noexcept {
+      return &*current_;
+    }
+
+    iterator& operator++() {
+      advance_();
+      return *this;
+    }
+
+    void operator++(int) {
+      advance_();
+    }
+
+    bool operator==(std::default_sentinel_t) const noexcept {
+      return reader_ == nullptr;
+    }
+
+  private:
+    void advance_() {
+      current_.reset(); // hand the buffer back before waiting for the next one
+      if (!reader_)
+        return;
+      if (reader_->done())
+        reader_ = nullptr;
+      else
+        current_.emplace(reader_->next());
+    }
+  };
+
+private:
+  std::ifstream file_; ///< read by the worker thread only
+  size_type extents_[Dims - 1]; ///< shape of a slice
+  size_type slice_size_; ///< elements per slice
+  size_type count_; ///< number of slices in the file
+  size_type next_ = 0; ///< index of the next slice handed out
+  size_type held_ = 0; ///< slices handed out and not yet destroyed
+
+  std::vector<std::unique_ptr<T[]>> buffers_; ///< prefetch + 1 slice buffers
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<size_type> free_; ///< buffers available to the worker
+  std::deque<std::pair<size_type, size_type>> ready_; ///< (slice index, buffer) read ahead
+  std::exception_ptr error_; ///< read error to rethrow on the consumer side
+  bool stop_ = false;
+
+  std::thread worker_; ///< started last
+
+public:
+  // hypervector_slice_reader(path, prefetch, size_type count...)
+  /// open file holding slices of given extents of dimensions 1..Dims-1
+  template<typename ...Sizes>
+  hypervector_slice_reader(
+      const std::string& path,
+      size_type prefetch,
+      typename std::enable_if<sizeof...(Sizes) == Dims - 2, size_type>::type size1,
+      Sizes&&... sizes)
+    : file_(path, std::ios::binary | std::ios::ate)
+    , extents_{size1, static_cast<size_type>(sizes)...}
+    , slice_size_((size1 * ... * static_cast<size_type>(sizes))) {
+    if (!file_)
+      throw std::runtime_error("hypervector_slice_reader: cannot open " + path);
+
+    auto file_size = static_cast<size_type>(file_.tellg());
+    auto slice_bytes = slice_size_ * sizeof(T);
+    if (slice_bytes == 0 || file_size % slice_bytes != 0)
+      throw std::invalid_argument("hypervector_slice_reader: file size is not a multiple of the slice size");
+    count_ = file_size / slice_bytes;
+    file_.seekg(0);
+
+    prefetch = std::max<size_type>(prefetch, 1);
+    for (size_type b = 0; b < prefetch + 1; ++b) {
+      buffers_.emplace_back(new T[slice_size_]);
+      free_.push_back(b);
+    }
+
+    worker_ = std::thread([this] { read_(); });
+  }
+
+
+  hypervector_slice_reader(const hypervector_slice_reader&) = delete;
+  hypervector_slice_reader& operator=(const hypervector_slice_reader&) = delete;
+
+
+  /// stops reading ahead; all slices must have been destroyed before
+  ~hypervector_slice_reader() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cond_.notify_all();
+    worker_.join();
+  }
+
+
+  /// wait for and take the next slice; rethrows errors of the background read
+  /// and throws std::logic_error instead of waiting forever if the caller
+  /// holds all prefetch + 1 slices
+  slice next() {
+    if (done())
+      throw std::out_of_range("hypervector_slice_reader::next");
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (ready_.empty() && held_ == buffers_.size())
+      throw std::logic_error("hypervector_slice_reader::next: all buffers held by slices");
+    cond_.wait(lock, [this] { return !ready_.empty() || error_; });
+    if (ready_.empty())
+      std::rethrow_exception(error_);
+
+    auto [index, buffer] = ready_.front();
+    ready_.pop_front();
+    ++next_;
+    ++held_;
+    lock.unlock();
+    return slice(this, index, buffer);
+  }
+
+
+  /// whether all slices have been handed out
+  bool done() const noexcept {
+    return (next_ >= count_);
+  }
+
+
+  /// number of slices along dimension 0
+  size_type size() const noexcept {
+    return count_;
+  }
+
+
+  template<size_type Dim>
+  size_type sizeOf() const noexcept {
+    static_assert(Dim < Dims, "hypervector_slice_reader::sizeOf");
+    if constexpr (Dim == 0)
+      return count_;
+    else
+      return extents_[Dim - 1];
+  }
+
+
+  /// single-pass range over the remaining slices
+  iterator begin() {
+    return iterator(this);
+  }
+
+
+  std::default_sentinel_t end() const noexcept {
+    return std::default_sentinel;
+  }
+
+private:
+  template<size_t ...Dim>
+  hypervector_ref<T, Dims - 1> ref_(size_type buffer, std::index_sequence<Dim...>) const {
+    return hypervector_ref<T, Dims - 1>(buffers_[buffer].get(), extents_[Dim]...);
+  }
+
+
+  void release_(size_type buffer) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_.push_back(buffer);
+      --held_;
+    }
+    cond_.notify_all();
+  }
+
+
+  void read_() {
+    for (size_type index = 0; index < count_; ++index) {
+      size_type buffer;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return stop_ || !free_.empty(); });
+        if (stop_)
+          return;
+        buffer = free_.front();
+        free_.pop_front();
+      }
+
+      file_.read(reinterpret_cast<char*>(buffers_[buffer].get()), static_cast<std::streamsize>(slice_size_ * sizeof(T)));
+
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (file_)
+          ready_.emplace_back(index, buffer);
+        else
+          error_ = std::make_exception_ptr(std::runtime_error("hypervector_slice_reader: read failed"));
+      }
+      cond_.notify_all();
+      if (!file_)
+        return;
+    }
+  }
+};
+
+#endif // HYPERVECTOR_STREAM_H
@@ -1,7 +1,26 @@
 #include "hypervector.h"
+#include "hypervector_compressed.h"
+#include "hypervector_linalg.h"
+#include "hypervector_stream.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <ranges>
 #include <string>
+#include <thread>
+#include <vector>
+
+#if __has_include(<sys/mman.h>)
+# include "hypervector_shm.h"
+# include <unistd.h>
+#endif
 
 hypervector<std::string, 3> reference(
     std::initializer_list<
@@ -196,5 +215,405 @@ int main(int /*argc*/, char** /*argv*/) {
     std::cout << "slice [4][3] of [5][4][3][2]:\n" << slice << "\n\n";
   }
 
+  { // test convert() and reshape()
+    hypervector<uint16_t, 3> raw(2, 3, 4);
+    uint16_t i = 0;
+    for (auto& v : raw)
+      v = i++ * 2500;
+
+    auto scaled = raw.convert<float>(0.5f, -1.0f);
+    success &= (scaled.sizeOf<1>() == 3 && scaled.at(1, 2, 3) == 23 * 1250.0f - 1.0f);
+    auto narrowed = raw.convert<int8_t>();
+    success &= (narrowed.at(0, 0, 0) == 0 && narrowed.at(1, 2, 3) == 127);
+
+    hypervector<double, 1> extremes{-1e300, -2.5, 2.5, 1e300, std::nan(""), 9.3e18};
+    auto clamped = extremes.convert<int64_t>();
+    success &= std::ranges::equal(clamped, std::vector<int64_t>{INT64_MIN, -2, 2, INT64_MAX, INT64_MIN, INT64_MAX});
+    hypervector<uint8_t, 1> bytes(6);
+    extremes.convert_to(bytes, 100.0);
+    success &= std::ranges::equal(bytes, std::vector<uint8_t>{0, 0, 250, 255, 0, 255});
+
+    hypervector<int, 1> signedness{-70000, -1, 40000, 70000};
+    success &= std::ranges::equal(signedness.convert<uint16_t>(), std::vector<uint16_t>{0, 0, 40000, 65535});
+    success &= std::ranges::equal(signedness.convert<int16_t>(), std::vector<int16_t>{-32768, -1, 32767, 32767});
+    success &= (signedness.convert<std::complex<double>>().at(2) == std::complex<double>(40000.0)); // not trivial
+
+    auto flat = scaled.reshape(6, 4);
+    success &= (flat.data() == scaled.data() && flat.at(5, 3) == scaled.at(1, 2, 3));
+    flat.at(2, 1) = -7.0f;
+    success &= (scaled.at(0, 2, 1) == -7.0f);
+    const auto& cscaled = scaled;
+    success &= (cscaled[1].reshape(12) == to_hypervector_ref(to_span(cscaled).subspan(12), 12));
+
+    try {
+      (void)scaled.reshape(5, 5);
+      success = false;
+    } catch (const std::invalid_argument&) {
+    }
+
+    try {
+      raw.convert_to(hypervector<float, 3>(2, 4, 3));
+      success = false;
+    } catch (const std::invalid_argument&) {
+    }
+  }
+
+  { // test gemm/gemv against naive loops
+    auto naive_gemm = [](double alpha, const hypervector_view<double, 2, true>& a, const hypervector_view<double, 2, true>& b, double beta, hypervector_view<double, 2, false> c) {
+      for (size_t i = 0; i < c.sizeOf<0>(); ++i)
+        for (size_t j = 0; j < c.sizeOf<1>(); ++j) {
+          double sum = 0.0;
+          for (size_t p = 0; p < a.sizeOf<1>(); ++p)
+            sum += a.at(i, p) * b.at(p, j);
+          c.at(i, j) = alpha * sum + beta * c.at(i, j);
+        }
+    };
+    auto near = [](const hypervector_view<double, 2, true>& lhs, const hypervector_view<double, 2, true>& rhs) {
+      return std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](double l, double r) {
+        return std::abs(l - r) <= 1e-9 * (1.0 + std::abs(r));
+      });
+    };
+    auto iota = [](auto& hvec, double scale) {
+      int i = 0;
+      for (auto& v : hvec)
+        v = scale * ((i++ % 17) - 8);
+    };
+
+    for (size_t size : {1, 7, 37, 160}) {
+      hypervector<double, 2> a(size, size + 3), b(size + 3, size + 9);
+      hypervector<double, 2> c(size, size + 9), expected;
+      iota(a, 0.5);
+      iota(b, 0.25);
+      iota(c, 1.0);
+      expected = c;
+      success &= (a.ld() == size + 3 && a.data() == &a.at(0, 0));
+
+      hypervector_linalg::gemm(2.0, a, b, 0.5, c, 3);
+      naive_gemm(2.0, a, b, 0.5, expected);
+      success &= near(c, expected);
+    }
+
+    {
+      hypervector<double, 3> a(3, 20, 30), b(3, 30, 10), c(3, 20, 10, 0.0), expected(3, 20, 10, 0.0);
+      iota(a, 0.5);
+      iota(b, 0.25);
+      hypervector_linalg::gemm_batched(1.0, a, b, 0.0, c, 2);
+      for (size_t i = 0; i < 3; ++i) {
+        naive_gemm(1.0, a[i], b[i], 0.0, expected[i]);
+        success &= near(c[i], expected[i]);
+      }
+    }
+
+    {
+      hypervector<double, 2> a(37, 11), x(11, 1), expected(37, 1, 1.0);
+      hypervector<double, 1> x1(11), y(37, 1.0);
+      iota(a, 0.5);
+      iota(x, 0.25);
+      std::copy(x.begin(), x.end(), x1.begin());
+      hypervector_linalg::gemv(2.0, a, x1, 0.5, y);
+      naive_gemm(2.0, a, x, 0.5, expected);
+      success &= std::equal(y.begin(), y.end(), expected.begin());
+    }
+
+    try {
+      hypervector<double, 2> a(2, 3), b(2, 3), c(2, 3);
+      hypervector_linalg::gemm(a, b, c);
+      success = false;
+    } catch (const std::invalid_argument&) {
+    }
+
+    try { // exceptions of worker threads reach the caller after all threads joined
+      hypervector_linalg::detail::parallel_for(4, 16, 1, [](unsigned t, size_t, size_t) {
+        if (t == 1)
+          throw std::bad_alloc();
+      });
+      success = false;
+    } catch (const std::bad_alloc&) {
+    }
+  }
+
+  { // test zero-copy interop with external buffers and std::span/std::mdspan
+    std::vector<int> buffer(4 * 3 * 2);
+    for (size_t i = 0; i < buffer.size(); ++i)
+      buffer[i] = static_cast<int>(i);
+
+    hypervector_ref<int, 3> ref(buffer.data(), 4, 3, 2);
+    success &= (ref.size() == buffer.size());
+    success &= (ref.offsetOf<0>() == 3 * 2 && ref.offsetOf<1>() == 2 && ref.offsetOf<2>() == 1);
+    success &= (ref.at(2, 1, 0) == 2 * 3 * 2 + 1 * 2);
+    ref[3][2][1] = -1;
+    success &= (buffer.back() == -1);
+    std::cout << "hypervector_ref(buffer, 4, 3, 2):\n" << ref << "\n\n";
+
+    {
+      // the shape is owned by the ref, i.e. copies outlive the original
+      auto copy = std::make_unique<hypervector_ref<int, 3>>(ref);
+      hypervector_ref<int, 3, true> const_copy(*copy);
+      copy.reset();
+      success &= (const_copy == ref);
+    }
+
+    hypervector<int, 3> hvec = ref;
+    success &= (hvec == ref);
+    success &= (hypervector_ref<int, 2>(hvec[1]) == ref[1]);
+
+    auto span = to_span(hvec[1]);
+    static_assert(std::is_same<decltype(span), std::span<int>>::value, "span type mismatch");
+    success &= (span.data() == &hvec.at(1, 0, 0) && span.size() == 3 * 2);
+    auto const_span = to_span(static_cast<const hypervector<int, 3>&>(hvec));
+    static_assert(std::is_same<decltype(const_span), std::span<const int>>::value, "span type mismatch");
+    success &= (const_span.size() == hvec.size());
+
+    auto from_span = to_hypervector_ref(std::span<const int>(buffer), 6, 4);
+    static_assert(std::is_same<decltype(from_span), hypervector_ref<int, 2, true>>::value, "ref type mismatch");
+    success &= (from_span.at(5, 3) == -1);
+    try {
+      (void)to_hypervector_ref(std::span<int>(buffer), 5, 5);
+      success = false;
+    } catch (const std::invalid_argument&) {
+    }
+
+#if defined(__cpp_lib_mdspan)
+    auto md = to_mdspan(hvec);
+    success &= (md.extent(0) == 4 && md.extent(1) == 3 && md.extent(2) == 2);
+    success &= (&md[2, 1, 0] == &hvec.at(2, 1, 0));
+    auto md_strided = to_mdspan_strided(hvec[3]);
+    success &= (md_strided.stride(0) == 2 && md_strided[2, 1] == -1);
+    success &= (to_hypervector_ref(md) == hvec);
+#endif
+  }
+
+  { // test compressed storage
+    hypervector<float, 3> field(16, 32, 40);
+    for (size_t x = 0; x < field.sizeOf<0>(); ++x)
+      for (size_t y = 0; y < field.sizeOf<1>(); ++y)
+        for (size_t z = 0; z < field.sizeOf<2>(); ++z)
+          field.at(x, y, z) = 280.0f + 10.0f * std::sin(0.2f * x) * std::cos(0.1f * y) + 0.5f * z;
+
+    hypervector_compressed<float, 3> compressed(field, 1000, 2);
+    success &= (compressed.block_count() == (16 * 32 * 40 + 999) / 1000);
+    success &= (compressed.uncompressed_bytes() >= 3 * compressed.compressed_bytes());
+    success &= (compressed.decompress() == field);
+    success &= (compressed.at(15, 31, 39) == field.at(15, 31, 39));
+    success &= (compressed.at(7, 3, 2) == field.at(7, 3, 2));
+
+    auto across = compressed.slice(0); // elements 0..1279 span two blocks
+    success &= (across == field[0]);
+    success &= (compressed.slice(9) == field[9]);
+    success &= (compressed.slice(14) == field[14]);
+
+    { // slices within a block share the cached block, which outlives its eviction
+      hypervector_compressed<float, 3> paired(field, 2 * 32 * 40, 1);
+      auto within = paired.slice(3); // second half of block 1
+      (void)paired.at(0, 0, 0);
+      (void)paired.at(15, 0, 0); // evicts block 1
+      success &= (within == field[3]);
+      success &= (paired.slice(3) == field[3]);
+    }
+
+    { // slices of zero elements neither touch the cache nor the (absent) blocks
+      hypervector_compressed<float, 3> flat(hypervector<float, 3>(3, 0, 5));
+      auto none = flat.slice(2);
+      success &= (flat.block_count() == 0 && none.empty() && none.sizeOf<1>() == 5);
+    }
+
+    { // concurrent readers decode misses outside the cache lock
+      hypervector_compressed<float, 3> shared(field, 1000, 2);
+      std::atomic<bool> equal = true;
+      std::vector<std::thread> readers;
+      for (size_t t = 0; t < 4; ++t)
+        readers.emplace_back([&, t] {
+          for (size_t x = t; x < 16 * 4; x += 3)
+            equal = equal && (shared.slice(x % 16) == field[x % 16]);
+        });
+      for (auto& reader : readers)
+        reader.join();
+      success &= equal;
+    }
+
+    { // movable, e.g. to keep many of them in a container
+      std::vector<hypervector_compressed<float, 3>> fields;
+      for (int n = 0; n < 4; ++n)
+        fields.emplace_back(field, 1000 * (n + 1));
+      auto moved = std::move(fields[2]);
+      fields[2] = std::move(fields[3]);
+      success &= (moved.block_size() == 3000 && moved.at(7, 3, 2) == field.at(7, 3, 2));
+      success &= (fields[2].block_size() == 4000 && fields[2].decompress() == field);
+    }
+
+    size_t count = 0;
+    compressed.for_each_block([&](size_t first, const float* data, size_t n) {
+      success &= std::equal(data, data + n, field.begin() + first);
+      count += n;
+    });
+    success &= (count == field.size());
+
+    hypervector<int, 2> mixed(7, 300);
+    int i = 0;
+    for (auto& v : mixed)
+      v = (i++ % 3 == 0 ? -i * 7919 : i);
+    success &= (hypervector_compressed<int, 2>(mixed, 512).decompress() == mixed);
+
+    try {
+      (void)compressed.at(16, 0, 0);
+      success = false;
+    } catch (const std::out_of_range&) {
+    }
+  }
+
+  { // test prefetching slice reader
+    hypervector<int, 3> grid(9, 4, 5);
+    int i = 0;
+    for (auto& v : grid)
+      v = i++;
+
+#if __has_include(<sys/mman.h>)
+    const auto path = (std::filesystem::temp_directory_path() / ("hypervector_test_slices_" + std::to_string(::getpid()) + ".bin")).string();
+#else
+    const auto path = (std::filesystem::temp_directory_path() / "hypervector_test_slices.bin").string();
+#endif
+    std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(grid.data()), grid.size() * sizeof(int));
+
+    {
+      hypervector_slice_reader<int, 3> reader(path, 2, 4, 5);
+      success &= (reader.size() == 9 && reader.sizeOf<2>() == 5);
+      size_t count = 0;
+      for (auto& slice : reader)
+        success &= (slice.index() == count++ && slice == grid[slice.index()]);
+      success &= (count == 9 && reader.done());
+    }
+
+    {
+      hypervector_slice_reader<int, 2> reader(path, 1, 20);
+      auto first = reader.next();
+      success &= (first.index() == 0 && first.at(19) == 19);
+      auto second = reader.next();
+      try { // both buffers held, waiting would never return
+        (void)reader.next();
+        success = false;
+      } catch (const std::logic_error&) {
+      }
+      first = std::move(second); // hands back the buffer of slice 0
+      success &= (first.index() == 1 && reader.next().index() == 2);
+    } // stops while the worker waits for a free buffer
+
+    { // the range works with std::ranges algorithms and views
+      hypervector_slice_reader<int, 3> reader(path, 2, 4, 5);
+      static_assert(std::ranges::input_range<decltype(reader)>);
+      size_t count = 0;
+      std::ranges::for_each(reader | std::views::take(4), [&](const auto& slice) {
+        success &= (slice.index() == count++ && slice == grid[slice.index()]);
+      });
+      success &= (count == 4);
+    }
+
+    try {
+      hypervector_slice_reader<int, 3> reader(path, 2, 7, 5);
+      success = false;
+    } catch (const std::invalid_argument&) {
+    }
+    std::filesystem::remove(path);
+  }
+
+#if __has_include(<sys/mman.h>)
+  { // test shared memory segments mapped at different addresses
+    const auto name = "/hypervector_test_" + std::to_string(::getpid());
+    auto writer = hypervector_shm<int, 3>::create(name.c_str(), 4 * 3 * 2);
+    success &= (writer.size() == 0 && writer.capacity() == 4 * 3 * 2);
+
+    writer.assign(2, 3, 2, 7);
+    auto reader = hypervector_shm<int, 3, true>::attach(name.c_str());
+    hypervector_shm<int, 3, true>::remove(name.c_str()); // mappings stay valid
+    success &= (reader.read([&](const hypervector_view<int, 3, true>& hvec) {
+      return hvec.data() != writer.data() && hvec == writer;
+    }));
+
+    const auto version = reader.version();
+    success &= !reader.writing(version);
+    writer.resize(4, 3, 2, 1);
+    writer.write([&](hypervector_view<int, 3, false>& hvec) {
+      // a read within one write must not see equal versions before and after
+      const auto during = reader.version();
+      success &= (reader.writing(during) && during != version + 2);
+      hvec.at(3, 2, 1) = -1;
+    });
+    success &= (reader.version() == version + 4);
+    success &= (reader.read([](const hypervector_view<int, 3, true>& hvec) {
+      return hvec.sizeOf<0>() == 4 && hvec.at(0, 0, 0) == 7 && hvec.at(2, 0, 0) == 1 && hvec.at(3, 2, 1) == -1;
+    }));
+    reader.read([](const hypervector_view<int, 3, true>& hvec) {
+      std::cout << "hypervector_shm<int, 3, true>::attach():\n" << hvec << "\n\n";
+    });
+
+    { // reshapes of equal element count never show a shape beyond capacity
+      std::atomic<bool> done = false;
+      std::thread reshaper([&] {
+        for (int n = 0; n < 100000; ++n) {
+          writer.resize(24, 1, 1);
+          writer.resize(1, 1, 24);
+        }
+        done = true;
+      });
+      size_t reads = 0;
+      bool beyond = false; // also checked in attempts that read() retries
+      while (!done || reads == 0) {
+        reader.read([&](const hypervector_view<int, 3, true>& hvec) {
+          beyond |= (hvec.size() > 24);
+          if (!beyond && hvec.size() > 0)
+            beyond |= (hvec.offsetOf(hvec.sizeOf<0>() - 1, hvec.sizeOf<1>() - 1, hvec.sizeOf<2>() - 1) >= 24);
+        });
+        ++reads;
+      }
+      success &= !beyond;
+      reshaper.join();
+      writer.resize(4, 3, 2);
+    }
+
+    try {
+      writer.resize(5, 3, 2);
+      success = false;
+    } catch (const std::length_error&) {
+    }
+
+    try {
+      (void)hypervector_shm<int, 2, true>::attach(name.c_str());
+      success = false;
+    } catch (const std::system_error&) { // already removed
+    }
+  }
+#endif
+
+  if (hypervector_instrumentation::enabled) { // test instrumentation counters
+    hypervector_instrumentation::reset();
+    const auto before = hypervector_instrumentation::snapshot();
+    {
+      hypervector<int, 2> hvec(2, 3, 7);
+      hvec.reserve(4, 3);
+      hvec.resize(4, 3, 1);
+      auto copy = hvec;
+      hvec.at(3, 2) = copy[0][1] + copy[1][2];
+      success &= (hypervector_instrumentation::snapshot().accesses_at == 1);
+      success &= (hypervector_instrumentation::snapshot().accesses_subscript == 2);
+
+      auto grids = hypervector_instrumentation::grids();
+      success &= (std::count_if(grids.begin(), grids.end(), [](const hypervector_instrumentation::grid& g) {
+        return g.dims == 2 && g.size == 4 * 3 && g.capacity == 4 * 3 && g.element_size == sizeof(int);
+      }) == 2);
+      success &= (hypervector_instrumentation::snapshot().grids_live == before.grids_live + 2);
+      hypervector_instrumentation::dump(std::cout) << "\n";
+    }
+    const auto after = hypervector_instrumentation::snapshot();
+    success &= (after.allocations == 3);
+    success &= (after.reallocations == 1);
+    success &= (after.deallocations == 3);
+    success &= (after.elements_constructed == 2 * 3 + 2 * 3);
+    success &= (after.elements_moved == 2 * 3);
+    success &= (after.elements_copied == 4 * 3);
+    success &= (after.elements_destroyed == 2 * 3 + 2 * 4 * 3);
+    success &= (after.bytes_reserved == before.bytes_reserved);
+    success &= (after.bytes_reserved_peak >= before.bytes_reserved + 2 * 4 * 3 * sizeof(int));
+    success &= (after.grids_live == before.grids_live);
+  }
+
   return (success ? EXIT_SUCCESS : EXIT_FAILURE);
 }
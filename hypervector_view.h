@@ -2,20 +2,32 @@
 #define HYPERVECTOR_VIEW_H
 
 #include "hypervector_detail.h"
+#include "hypervector_instrumentation.h"
 
 #include <algorithm>
 #include <cstddef>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
+
+template<typename T, size_t Dims>
+struct hypervector;
+
+template<typename T, size_t Dims, bool IsConst>
+struct hypervector_ref;
 
 /// view on hypervector container providing element read and write accessors
 template<typename T, size_t Dims, bool IsConst>
 struct hypervector_view
 {
   using value_type = T;
-  using reference = T&;
+  using reference = typename std::conditional<IsConst,
+    const T&,
+    T&>::type;
   using const_reference = const T&;
-  using pointer = T*;
+  using pointer = typename std::conditional<IsConst,
+    const T*,
+    T*>::type;
   using const_pointer = const T*;
   using iterator = pointer;
   using const_iterator = const_pointer;
@@ -54,6 +66,7 @@ public:
   template<typename ...Indices>
   typename std::enable_if<sizeof...(Indices) == Dims, reference>::type
   at(Indices&&... indices) {
+    hypervector_detail::accessed_at();
     return *(vals_ + indexOf_(std::forward<Indices>(indices)...));
   }
 
@@ -62,6 +75,7 @@ public:
   template<typename ...Indices>
   typename std::enable_if<sizeof...(Indices) == Dims, const_reference>::type
   at(Indices&&... indices) const {
+    hypervector_detail::accessed_at();
     return *(vals_ + indexOf_(std::forward<Indices>(indices)...));
   }
 
@@ -78,6 +92,7 @@ public:
   template<size_t Dims_ = Dims,
            typename = typename std::enable_if<(Dims_ == 1)>::type>
   reference operator[](size_type pos) {
+    hypervector_detail::accessed_subscript();
     return *(vals_ + pos);
   }
 
@@ -94,6 +109,7 @@ public:
   template<size_t Dims_ = Dims,
            typename = typename std::enable_if<(Dims_ == 1)>::type>
   const_reference operator[](size_type pos) const {
+    hypervector_detail::accessed_subscript();
     return *(vals_ + pos);
   }
 
@@ -129,6 +145,85 @@ public:
   }
 
 
+  pointer data() noexcept {
+    return vals_;
+  }
+
+
+  const_pointer data() const noexcept {
+    return vals_;
+  }
+
+
+  /// leading dimension, i.e. the row stride in elements as e.g. BLAS' lda
+  template<size_t Dims_ = Dims,
+           typename = typename std::enable_if<(Dims_ == 2)>::type>
+  size_type ld() const noexcept {
+    return dims_[0].offset;
+  }
+
+
+  // hypervector<U, Dims> convert<U>()
+  /// copy with elements converted to U, saturated to its range if U is integral
+  template<typename U>
+  hypervector<U, Dims> convert() const {
+    return converted_<U>([this](U* out) {
+      hypervector_detail::convert_n_(vals_, size(), out);
+    });
+  }
+
+
+  // hypervector<U, Dims> convert<U>(scale, offset)
+  /// copy with elements converted to U as value * scale + offset, saturated to its range if U is integral;
+  /// computed in float for small integral types and float, else in double
+  template<typename U>
+  hypervector<U, Dims> convert(
+      hypervector_detail::convert_type<T, U> scale,
+      hypervector_detail::convert_type<T, U> offset = 0) const {
+    return converted_<U>([this, scale, offset](U* out) {
+      hypervector_detail::convert_n_(vals_, size(), out, scale, offset);
+    });
+  }
+
+
+  /// like convert() into the existing storage of a view (or container) of equal shape
+  template<typename U>
+  void convert_to(hypervector_view<U, Dims, false> other) const {
+    if (!std::equal(dims_, dims_ + Dims, other.dims_))
+      throw std::invalid_argument("hypervector_view::convert_to: shape mismatch");
+    hypervector_detail::convert_n_(vals_, size(), other.vals_);
+  }
+
+
+  template<typename U>
+  void convert_to(
+      hypervector_view<U, Dims, false> other,
+      hypervector_detail::convert_type<T, U> scale,
+      hypervector_detail::convert_type<T, U> offset = 0) const {
+    if (!std::equal(dims_, dims_ + Dims, other.dims_))
+      throw std::invalid_argument("hypervector_view::convert_to: shape mismatch");
+    hypervector_detail::convert_n_(vals_, size(), other.vals_, scale, offset);
+  }
+
+
+  // hypervector_ref<T, N> reshape(size_type count...)
+  /// the elements in a different shape of equal size without copying;
+  /// refers to this view's storage, i.e. is invalidated like the view
+  template<typename ...Sizes>
+  hypervector_ref<T, sizeof...(Sizes), IsConst> reshape(Sizes... sizes) {
+    reshape_(sizes...);
+    return hypervector_ref<T, sizeof...(Sizes), IsConst>(vals_, static_cast<size_type>(sizes)...);
+  }
+
+
+  // hypervector_ref<T, N, true> reshape(size_type count...) const
+  template<typename ...Sizes>
+  hypervector_ref<T, sizeof...(Sizes), true> reshape(Sizes... sizes) const {
+    reshape_(sizes...);
+    return hypervector_ref<T, sizeof...(Sizes), true>(vals_, static_cast<size_type>(sizes)...);
+  }
+
+
   iterator begin() noexcept {
     return vals_;
   }
@@ -187,6 +282,34 @@ public:
   }
 
 protected:
+  // container of U in this view's shape with elements written once by f(data);
+  // trivial types are written to uninitialized storage, others assigned after value-initialization
+  template<typename U, typename F>
+  hypervector<U, Dims> converted_(F&& f) const {
+    if constexpr (std::is_trivially_default_constructible<U>::value && std::is_trivially_copy_assignable<U>::value) {
+      return hypervector<U, Dims>(dims_, std::forward<F>(f));
+    } else {
+      auto result = hypervector_<U>(std::make_index_sequence<Dims>());
+      f(result.data());
+      return result;
+    }
+  }
+
+
+  template<typename U, size_t ...Dim>
+  hypervector<U, Dims> hypervector_(std::index_sequence<Dim...>) const {
+    return hypervector<U, Dims>(dims_[Dim].size...);
+  }
+
+
+  template<typename ...Sizes>
+  void reshape_(Sizes... sizes) const {
+    static_assert(sizeof...(Sizes) > 0, "hypervector_view::reshape");
+    if ((static_cast<size_type>(sizes) * ...) != size())
+      throw std::invalid_argument("hypervector_view::reshape: element count mismatch");
+  }
+
+
   template<typename ...Indices>
   typename std::enable_if<sizeof...(Indices) <= Dims - 1, size_type>::type
   indexOf_(
@@ -220,6 +343,18 @@ protected:
   // XXX friend declaration for hypervector's construct/assign from view
   template<typename, size_t>
   friend struct hypervector;
+
+  // friend declaration for comparison of views of different types
+  template<typename, size_t, bool>
+  friend struct hypervector_view;
+
+  // friend declaration for hypervector_compressed's construct from view
+  template<typename, size_t>
+  friend struct hypervector_compressed;
+
+  // friend declaration for hypervector_ref's construct from view
+  template<typename, size_t, bool>
+  friend struct hypervector_ref;
 };
 
 #endif // HYPERVECTOR_VIEW_H